@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ * All rights reserved.
+ *
+ * This file is part of the examples of the QtOrm library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the sequality software engineering e.U. nor the
+ *    names of its contributors may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Generates a large navigationdb database for profiling. Communities are distributed over the
+// provinces according to Zipf's law: the province of rank k gets communities proportional to
+// 1 / k^skew. The same seed always generates the same database.
+//
+// navigationdbgen --communities 1000000 --provinces 100 --mode raw navigationdb.db
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QOrmEntityInstanceCache>
+#include <QOrmError>
+#include <QOrmMetadataCache>
+#include <QOrmSession>
+#include <QOrmSessionConfiguration>
+#include <QOrmSqliteConfiguration>
+#include <QOrmSqliteProvider>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
+
+#include "../navigationdb/domain/community.h"
+#include "../navigationdb/domain/province.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    struct Options
+    {
+        QString databaseName;
+        int provinces{100};
+        int communities{1000000};
+        double skew{1.0};
+        quint32 seed{1};
+        bool isRaw{false};
+        int batchSize{10000};
+        int cacheSize{100000};
+    };
+
+    // The province index of rank k is drawn with probability proportional to 1 / k^skew
+    class ZipfDistribution
+    {
+    public:
+        ZipfDistribution(int size, double skew)
+        {
+            m_cumulativeWeights.reserve(size);
+
+            double sum = 0.0;
+
+            for (int rank = 1; rank <= size; ++rank)
+            {
+                sum += 1.0 / std::pow(rank, skew);
+                m_cumulativeWeights.push_back(sum);
+            }
+        }
+
+        int operator()(QRandomGenerator& random) const
+        {
+            double value = random.generateDouble() * m_cumulativeWeights.back();
+            auto it = std::upper_bound(std::cbegin(m_cumulativeWeights),
+                                       std::cend(m_cumulativeWeights),
+                                       value);
+
+            return qMin(static_cast<int>(it - std::cbegin(m_cumulativeWeights)),
+                        m_cumulativeWeights.size() - 1);
+        }
+
+    private:
+        QVector<double> m_cumulativeWeights;
+    };
+
+    // The values of a community, independent of the way it is inserted
+    struct CommunityData
+    {
+        QString name;
+        int province{0};
+        QString postCode;
+        int population{0};
+        qreal latitude{0};
+        qreal longitude{0};
+    };
+
+    class CommunityGenerator
+    {
+    public:
+        explicit CommunityGenerator(const Options& options)
+            : m_random{options.seed}
+            , m_distribution{options.provinces, options.skew}
+        {
+            // every province is an area around a random center in Austria
+            for (int i = 0; i < options.provinces; ++i)
+            {
+                m_centers.push_back(qMakePair(46.9 + m_random.generateDouble() * 1.6,
+                                              10.0 + m_random.generateDouble() * 6.7));
+            }
+        }
+
+        CommunityData next()
+        {
+            CommunityData data;
+
+            ++m_count;
+            data.province = m_distribution(m_random);
+            data.name = QStringLiteral("Community %1").arg(m_count);
+            data.postCode = QString::number(1000 + m_random.bounded(9000));
+            // mostly small communities, a few large ones
+            data.population =
+                static_cast<int>(std::exp(5.0 + 7.0 * std::pow(m_random.generateDouble(), 2)));
+            data.latitude = m_centers[data.province].first + m_random.generateDouble() - 0.5;
+            data.longitude = m_centers[data.province].second + m_random.generateDouble() - 0.5;
+
+            return data;
+        }
+
+    private:
+        QRandomGenerator m_random;
+        ZipfDistribution m_distribution;
+        QVector<QPair<qreal, qreal>> m_centers;
+        int m_count{0};
+    };
+
+    QVector<Province*> createProvinces(QOrmSession& session, const Options& options)
+    {
+        QVector<Province*> provinces;
+        auto token = session.declareTransaction(QOrm::TransactionPropagation::Require,
+                                                QOrm::TransactionAction::Commit);
+
+        for (int i = 1; i <= options.provinces; ++i)
+        {
+            Province* province = new Province{QStringLiteral("Province %1").arg(i)};
+
+            if (!session.merge(province))
+                return {};
+
+            provinces.push_back(province);
+        }
+
+        if (!token.commit())
+            return {};
+
+        // the instances are used until the end, they must not be evicted from the cache
+        for (Province* province : qAsConst(provinces))
+            session.entityInstanceCache()->pin(province);
+
+        return provinces;
+    }
+
+    // Inserts the communities through the session in batches of one transaction each
+    bool generateWithSession(QOrmSession& session,
+                             const QVector<Province*>& provinces,
+                             const Options& options)
+    {
+        CommunityGenerator generator{options};
+
+        for (int inserted = 0; inserted < options.communities;)
+        {
+            int batchSize = qMin(options.batchSize, options.communities - inserted);
+            QVector<Community*> communities;
+            QHash<Province*, QVector<Community*>> communityLists;
+
+            for (int i = 0; i < batchSize; ++i)
+            {
+                CommunityData data = generator.next();
+                Province* province = provinces[data.province];
+                Community* community = new Community{data.name,
+                                                     province,
+                                                     data.postCode,
+                                                     data.population,
+                                                     data.latitude,
+                                                     data.longitude};
+
+                communities.push_back(community);
+                communityLists[province].push_back(community);
+            }
+
+            // The back-references must list the merged communities. Only the current batch is
+            // listed, which keeps the consistency checks of the session linear.
+            for (auto it = std::cbegin(communityLists); it != std::cend(communityLists); ++it)
+                it.key()->setCommunityList(it.value());
+
+            {
+                auto token = session.declareTransaction(QOrm::TransactionPropagation::Require,
+                                                        QOrm::TransactionAction::Commit);
+
+                for (Community* community : qAsConst(communities))
+                {
+                    if (!session.merge(community))
+                        return false;
+                }
+
+                if (!token.commit())
+                    return false;
+            }
+
+            // the communities of the batch may be evicted from the cache from now on
+            for (auto it = std::cbegin(communityLists); it != std::cend(communityLists); ++it)
+                it.key()->setCommunityList({});
+
+            inserted += batchSize;
+            qInfo() << "Inserted" << inserted << "communities";
+        }
+
+        return true;
+    }
+
+    // Inserts the communities with prepared statements on the connection of the session
+    bool generateRaw(QOrmSession& session,
+                     const QVector<Province*>& provinces,
+                     const Options& options)
+    {
+        // the schema is created by the session
+        if (session.from<Community>().count() < 0)
+            return false;
+
+        const QOrmMetadata& entity = session.metadataCache()->get<Community>();
+        const QStringList properties{
+            "name", "province", "postCode", "population", "latitude", "longitude"};
+        QStringList fields;
+
+        for (const QString& property : properties)
+            fields.push_back(entity.classPropertyMapping(property)->tableFieldName());
+
+        QSqlDatabase database =
+            static_cast<QOrmSqliteProvider*>(session.configuration().provider())->database();
+        QSqlQuery query{database};
+
+        if (!query.prepare(QStringLiteral("INSERT INTO %1(%2) VALUES(?%3)")
+                               .arg(entity.tableName(),
+                                    fields.join(','),
+                                    QStringLiteral(",?").repeated(fields.size() - 1))))
+        {
+            qCritical() << "Unable to prepare the statement:" << query.lastError().text();
+            return false;
+        }
+
+        CommunityGenerator generator{options};
+
+        for (int inserted = 0; inserted < options.communities;)
+        {
+            int batchSize = qMin(options.batchSize, options.communities - inserted);
+
+            if (!database.transaction())
+                return false;
+
+            for (int i = 0; i < batchSize; ++i)
+            {
+                CommunityData data = generator.next();
+
+                query.addBindValue(data.name);
+                query.addBindValue(provinces[data.province]->id());
+                query.addBindValue(data.postCode);
+                query.addBindValue(data.population);
+                query.addBindValue(data.latitude);
+                query.addBindValue(data.longitude);
+
+                if (!query.exec())
+                {
+                    qCritical() << "Unable to insert a community:" << query.lastError().text();
+                    database.rollback();
+                    return false;
+                }
+            }
+
+            if (!database.commit())
+                return false;
+
+            inserted += batchSize;
+            qInfo() << "Inserted" << inserted << "communities";
+        }
+
+        return true;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    qRegisterOrmEntity<Province, Community>();
+
+    QCoreApplication app{argc, argv};
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates a large navigationdb database for profiling");
+    parser.addHelpOption();
+    parser.addPositionalArgument("database", "The SQLite database file, recreated if it exists");
+
+    QCommandLineOption provincesOption{"provinces", "Number of provinces.", "count", "100"};
+    QCommandLineOption communitiesOption{
+        "communities", "Number of communities.", "count", "1000000"};
+    QCommandLineOption skewOption{
+        "skew", "Zipf exponent of the communities per province, 0 is uniform.", "exponent", "1.0"};
+    QCommandLineOption seedOption{"seed", "Seed of the random generator.", "seed", "1"};
+    QCommandLineOption modeOption{"mode",
+                                  "session to insert through QOrmSession, raw for prepared "
+                                  "statements.",
+                                  "mode",
+                                  "session"};
+    QCommandLineOption batchOption{"batch", "Communities per transaction.", "count", "10000"};
+    QCommandLineOption cacheOption{"cache-size",
+                                   "Entity instance cache size of the session, 0 is unlimited.",
+                                   "count",
+                                   "100000"};
+
+    parser.addOptions({provincesOption,
+                       communitiesOption,
+                       skewOption,
+                       seedOption,
+                       modeOption,
+                       batchOption,
+                       cacheOption});
+    parser.process(app);
+
+    Options options;
+    options.databaseName = parser.positionalArguments().value(0, "navigationdb.db");
+    options.provinces = qMax(1, parser.value(provincesOption).toInt());
+    options.communities = qMax(0, parser.value(communitiesOption).toInt());
+    options.skew = qMax(0.0, parser.value(skewOption).toDouble());
+    options.seed = parser.value(seedOption).toUInt();
+    options.isRaw = parser.value(modeOption) == "raw";
+    options.batchSize = qMax(1, parser.value(batchOption).toInt());
+    options.cacheSize = qMax(0, parser.value(cacheOption).toInt());
+
+    if (!options.isRaw && parser.value(modeOption) != "session")
+    {
+        qCritical() << "Unknown mode" << parser.value(modeOption);
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    bool isSuccessful = false;
+
+    {
+        QOrmSqliteConfiguration sqliteConfiguration;
+        sqliteConfiguration.setDatabaseName(options.databaseName);
+        sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Recreate);
+        QOrmSqliteProvider* sqliteProvider = new QOrmSqliteProvider{sqliteConfiguration};
+
+        QOrmSession session{QOrmSessionConfiguration{sqliteProvider, false, options.cacheSize}};
+
+        QVector<Province*> provinces = createProvinces(session, options);
+
+        if (provinces.isEmpty())
+        {
+            qCritical() << "Unable to create the provinces:" << session.lastError();
+            return 1;
+        }
+
+        timer.start();
+
+        isSuccessful = options.isRaw ? generateRaw(session, provinces, options)
+                                     : generateWithSession(session, provinces, options);
+
+        if (!isSuccessful)
+            qCritical() << "Unable to create the communities:" << session.lastError();
+    }
+
+    qint64 elapsed = qMax(qint64{1}, timer.elapsed());
+
+    qInfo().noquote() << QStringLiteral("%1 communities in %2 ms, %3 rows/s, %4 MiB")
+                             .arg(options.communities)
+                             .arg(elapsed)
+                             .arg(qint64{options.communities} * 1000 / elapsed)
+                             .arg(QFileInfo{options.databaseName}.size() / 1024.0 / 1024.0,
+                                  0,
+                                  'f',
+                                  1);
+
+    return isSuccessful ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+QT += orm # enable the ORM module
+QT += sql
+QT -= gui
+
+CONFIG += c++17 console # required by QtOrm
+CONFIG -= app_bundle
+
+TARGET = navigationdbgen
+TEMPLATE = app
+
+HEADERS += \
+    ../navigationdb/domain/province.h \
+    ../navigationdb/domain/community.h \
+
+SOURCES += \
+    ../navigationdb/domain/province.cpp \
+    ../navigationdb/domain/community.cpp \
+    main.cpp
+
+target.path = $$[QT_INSTALL_EXAMPLES]/orm/navigationdbgen
+INSTALLS += target
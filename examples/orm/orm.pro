@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS += navigationdb
\ No newline at end of file
+SUBDIRS += navigationdb navigationdbgen
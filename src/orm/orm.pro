@@ -7,15 +7,19 @@ QMAKE_DOCS = $$PWD/doc/qtorm.qdocconf
 PUBLIC_HEADERS += \
     qormabstractprovider.h \
     qormclassproperty.h \
+    qormcolumnbatch.h \
     qormentityinstancecache.h \
     qormentitylistmodel.h \
+    qormentitytraits.h \
     qormerror.h \
     qormfilter.h \
     qormfilterexpression.h \
     qormglobal.h \
+    qormlivequery.h \
     qormmetadata.h \
     qormmetadatacache.h \
     qormorder.h \
+    qormproperty.h \
     qormpropertymapping.h \
     qormquery.h \
     qormquerybuilder.h \
@@ -25,6 +29,7 @@ PUBLIC_HEADERS += \
     qormsessionconfiguration.h \
     qormsqliteconfiguration.h \
     qormsqliteprovider.h \
+    qormstatistics.h \
     qormtransactiontoken.h \
 
 PRIVATE_HEADERS = \
@@ -42,9 +47,11 @@ SOURCES += \
     qormfilterexpression.cpp \
     qormglobal.cpp \
     qormglobal_p.cpp \
+    qormlivequery.cpp \
     qormmetadata.cpp \
     qormmetadatacache.cpp \
     qormorder.cpp \
+    qormproperty.cpp \
     qormpropertymapping.cpp \
     qormquery.cpp \
     qormquerybuilder.cpp \
@@ -55,6 +62,7 @@ SOURCES += \
     qormsqliteconfiguration.cpp \
     qormsqliteprovider.cpp \
     qormsqlitestatementgenerator_p.cpp \
+    qormstatistics.cpp \
     qormtransactiontoken.cpp \
 
 HEADERS += $$PUBLIC_HEADERS $$PRIVATE_HEADERS
@@ -63,4 +71,10 @@ load(qt_module)
 
 CONFIG += c++17
 
+# Use the SQLite C API of the Qt SQLite driver, which must be built with -system-sqlite
+qtorm_sqlite3_api {
+    DEFINES += QTORM_USE_SQLITE3_API
+    LIBS += -lsqlite3
+}
+
 DEFINES -= QT_ASCII_CAST_WARNINGS
@@ -19,9 +19,65 @@
  */
 
 #include "qormabstractprovider.h"
+#include "qormerror.h"
 
 QT_BEGIN_NAMESPACE
 
 QOrmAbstractProvider::~QOrmAbstractProvider() = default;
 
+QOrmError QOrmAbstractProvider::createSavepoint(const QString& name)
+{
+    Q_UNUSED(name)
+    return QOrmError{QOrm::ErrorType::Other, QStringLiteral("Savepoints are not supported")};
+}
+
+QOrmError QOrmAbstractProvider::releaseSavepoint(const QString& name)
+{
+    Q_UNUSED(name)
+    return QOrmError{QOrm::ErrorType::Other, QStringLiteral("Savepoints are not supported")};
+}
+
+QOrmError QOrmAbstractProvider::rollbackToSavepoint(const QString& name)
+{
+    Q_UNUSED(name)
+    return QOrmError{QOrm::ErrorType::Other, QStringLiteral("Savepoints are not supported")};
+}
+
+QOrmError QOrmAbstractProvider::readValues(const QOrmQuery& query, const ValueRowHandler& handler)
+{
+    Q_UNUSED(query)
+    Q_UNUSED(handler)
+    return QOrmError{QOrm::ErrorType::Other, QStringLiteral("Reading values is not supported")};
+}
+
+QOrmAbstractProvider* QOrmAbstractProvider::createBackgroundProvider() const
+{
+    return nullptr;
+}
+
+QOrmError QOrmAbstractProvider::synchronizeSchema(const QOrmRelation& relation)
+{
+    Q_UNUSED(relation)
+    return QOrmError{QOrm::ErrorType::None, {}};
+}
+
+void QOrmAbstractProvider::detectExternalChanges(QOrmEntityInstanceCache& entityInstanceCache)
+{
+    Q_UNUSED(entityInstanceCache)
+}
+
+QOrmStatistics QOrmAbstractProvider::statistics() const
+{
+    return {};
+}
+
+void QOrmAbstractProvider::resetStatistics()
+{
+}
+
+void QOrmAbstractProvider::setStatementObserver(QOrmStatistics::StatementObserver observer)
+{
+    Q_UNUSED(observer)
+}
+
 QT_END_NAMESPACE
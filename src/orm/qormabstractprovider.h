@@ -23,6 +23,9 @@
 
 #include <QtOrm/qormglobal.h>
 #include <QtOrm/qormqueryresult.h>
+#include <QtOrm/qormstatistics.h>
+
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 
@@ -31,10 +34,17 @@ class QOrmEntityInstanceCache;
 class QOrmError;
 class QOrmMetadataCache;
 class QOrmQuery;
+class QOrmRelation;
+class QString;
 
 class Q_ORM_EXPORT QOrmAbstractProvider
 {
 public:
+    // Called for every row with the values of the property mappings of the projection, in the
+    // order of QOrmMetadata::propertyMappings(). References are represented by the object ID of
+    // the referenced instance, transient properties by an invalid QVariant.
+    using ValueRowHandler = std::function<void(const QVector<QVariant>& values)>;
+
     virtual ~QOrmAbstractProvider();
 
     virtual QOrmError connectToBackend() = 0;
@@ -45,8 +55,37 @@ public:
     virtual QOrmError commitTransaction() = 0;
     virtual QOrmError rollbackTransaction() = 0;
 
+    // Savepoints within the active transaction, used for nested transactions. Return an error if
+    // the backend does not support them.
+    virtual QOrmError createSavepoint(const QString& name);
+    virtual QOrmError releaseSavepoint(const QString& name);
+    virtual QOrmError rollbackToSavepoint(const QString& name);
+
     virtual QOrmQueryResult<QObject> execute(const QOrmQuery& query,
                                              QOrmEntityInstanceCache& entityInstanceCache) = 0;
+
+    // Executes a read query without creating, caching, or updating entity instances. Returns an
+    // error if the backend does not support it.
+    virtual QOrmError readValues(const QOrmQuery& query, const ValueRowHandler& handler);
+
+    // Creates an unconnected provider for reads on another thread. It uses its own connection to
+    // the same database and does not modify the schema. Returns nullptr if the backend does not
+    // support concurrent connections.
+    virtual QOrmAbstractProvider* createBackgroundProvider() const;
+
+    // Brings the schema of the relation in line with the entities, as done before every query
+    virtual QOrmError synchronizeSchema(const QOrmRelation& relation);
+
+    // Marks the cached instances that have been changed in the backend by other writers since
+    // the last call as stale
+    virtual void detectExternalChanges(QOrmEntityInstanceCache& entityInstanceCache);
+
+    // Statistics of the statements executed by the provider. The default implementation collects
+    // none.
+    virtual QOrmStatistics statistics() const;
+    virtual void resetStatistics();
+    // Called after every statement executed by the provider
+    virtual void setStatementObserver(QOrmStatistics::StatementObserver observer);
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef QORMCOLUMNBATCH_H
+#define QORMCOLUMNBATCH_H
+
+#include <QtOrm/qormglobal.h>
+
+#include <QtCore/qbitarray.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// The values of the selected properties stored column by column: one contiguous array per
+// property, and a bitmap per property with the bits set for NULL values. NULL values are stored
+// as default-constructed values.
+template<typename... Ts>
+class QOrmColumnBatch
+{
+public:
+    static constexpr int columnCount = static_cast<int>(sizeof...(Ts));
+
+    Q_REQUIRED_RESULT
+    int size() const { return m_size; }
+
+    template<int Column>
+    Q_REQUIRED_RESULT const auto& column() const
+    {
+        return std::get<Column>(m_columns);
+    }
+
+    template<int Column>
+    Q_REQUIRED_RESULT const QBitArray& nulls() const
+    {
+        return m_nulls[Column];
+    }
+
+    template<int Column>
+    Q_REQUIRED_RESULT bool isNull(int row) const
+    {
+        return m_nulls[Column].testBit(row);
+    }
+
+    // Appends a row with the values at the given indices
+    void append(const QVector<QVariant>& values, const std::array<int, sizeof...(Ts)>& indices)
+    {
+        appendRow(values, indices, std::index_sequence_for<Ts...>{});
+        ++m_size;
+    }
+
+    void clear()
+    {
+        m_columns = {};
+        m_nulls = {};
+        m_size = 0;
+    }
+
+private:
+    template<std::size_t... Columns>
+    void appendRow(const QVector<QVariant>& values,
+                   const std::array<int, sizeof...(Ts)>& indices,
+                   std::index_sequence<Columns...>)
+    {
+        (appendValue<Columns>(values[indices[Columns]]), ...);
+    }
+
+    template<std::size_t Column>
+    void appendValue(const QVariant& value)
+    {
+        using Value = std::tuple_element_t<Column, std::tuple<Ts...>>;
+
+        QBitArray& nulls = m_nulls[Column];
+        nulls.resize(m_size + 1);
+
+        if (!value.isValid())
+        {
+            nulls.setBit(m_size);
+            std::get<Column>(m_columns).emplace_back();
+        }
+        else
+        {
+            std::get<Column>(m_columns).push_back(value.value<Value>());
+        }
+    }
+
+    std::tuple<std::vector<Ts>...> m_columns;
+    std::array<QBitArray, sizeof...(Ts)> m_nulls;
+    int m_size{0};
+};
+
+QT_END_NAMESPACE
+
+#endif // QORMCOLUMNBATCH_H
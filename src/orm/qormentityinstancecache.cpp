@@ -27,6 +27,10 @@
 #include <QSet>
 #include <QVariant>
 
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
 QT_BEGIN_NAMESPACE
 
 class QOrmEntityInstanceCachePrivate : public QObject
@@ -36,21 +40,209 @@ class QOrmEntityInstanceCachePrivate : public QObject
     friend class QOrmEntityInstanceCache;
     using ObjectId = QPair<QString, QVariant>;
 
+    struct Entry
+    {
+        ObjectId objectId;
+        QOrmMetadata metadata;
+        std::list<QObject*>::iterator lruPosition;
+        int pinCount{0};
+        bool isStale{false};
+        // values of the mapped properties as last read from or written to the database
+        QVector<QVariant> persistedValues;
+    };
+
+    // Instances that reference each other. They are evicted together, otherwise the remaining
+    // cached instances would be left with dangling pointers.
+    struct Component
+    {
+        QVector<QObject*> instances;
+        // the age of the most recently used instance
+        int age{0};
+        // an instance has unsaved changes, is pinned, or is owned by a parent object
+        bool isKept{false};
+    };
+
 private slots:
     void onEntityInstanceChanged();
+    void onEntityInstanceDestroyed(QObject* instance);
 
 private:
-    QHash<QObject*, ObjectId> m_cache;
+    void remove(QObject* instance);
+    void touch(Entry& entry);
+    void recordPersistedValues(QObject* instance, Entry& entry);
+    std::vector<Component> components() const;
+    void evict(const Component& component);
+    void trim(int targetSize);
+
+    std::unordered_map<QObject*, Entry> m_cache;
     QMap<ObjectId, QObject*> m_byObjectId;
     QSet<const QObject*> m_modifiedInstances;    
+    // least recently used instances first
+    std::list<QObject*> m_lru;
+    int m_maximumSize{0};
+    qint64 m_hitCount{0};
+    qint64 m_missCount{0};
 };
 
 void QOrmEntityInstanceCachePrivate::onEntityInstanceChanged()
 {
-    Q_ASSERT(m_cache.contains(sender()));
+    Q_ASSERT(m_cache.find(sender()) != std::end(m_cache));
     m_modifiedInstances.insert(sender());
 }
 
+void QOrmEntityInstanceCachePrivate::onEntityInstanceDestroyed(QObject* instance)
+{
+    // the instance has been deleted by the user: forget it without touching the object
+    remove(instance);
+}
+
+void QOrmEntityInstanceCachePrivate::remove(QObject* instance)
+{
+    auto it = m_cache.find(instance);
+
+    if (it == std::end(m_cache))
+        return;
+
+    m_byObjectId.remove(it->second.objectId);
+    m_modifiedInstances.remove(instance);
+    m_lru.erase(it->second.lruPosition);
+    m_cache.erase(it);
+}
+
+void QOrmEntityInstanceCachePrivate::touch(Entry& entry)
+{
+    m_lru.splice(std::end(m_lru), m_lru, entry.lruPosition);
+}
+
+void QOrmEntityInstanceCachePrivate::recordPersistedValues(QObject* instance, Entry& entry)
+{
+    const std::vector<QOrmPropertyMapping>& mappings = entry.metadata.propertyMappings();
+
+    entry.persistedValues.clear();
+    entry.persistedValues.reserve(static_cast<int>(mappings.size()));
+
+    for (const QOrmPropertyMapping& mapping : mappings)
+    {
+        entry.persistedValues.push_back(
+            mapping.isTransient() ? QVariant{} : QOrmPrivate::propertyValue(instance, mapping));
+    }
+}
+
+std::vector<QOrmEntityInstanceCachePrivate::Component>
+QOrmEntityInstanceCachePrivate::components() const
+{
+    // union-find over the reference graph
+    QHash<QObject*, QObject*> parents;
+    parents.reserve(static_cast<int>(m_cache.size()));
+
+    for (const auto& [instance, entry] : m_cache)
+        parents.insert(instance, instance);
+
+    auto findRoot = [&parents](QObject* instance) {
+        while (parents[instance] != instance)
+        {
+            parents[instance] = parents[parents[instance]];
+            instance = parents[instance];
+        }
+
+        return instance;
+    };
+
+    auto unite = [&parents, &findRoot](QObject* lhs, QObject* rhs) {
+        if (rhs == nullptr || !parents.contains(rhs))
+            return;
+
+        parents[findRoot(lhs)] = findRoot(rhs);
+    };
+
+    for (const auto& [instance, entry] : m_cache)
+    {
+        for (const QOrmPropertyMapping& mapping : entry.metadata.propertyMappings())
+        {
+            if (!mapping.isReference())
+                continue;
+
+            QVariant value = QOrmPrivate::propertyValue(instance, mapping);
+
+            if (mapping.isTransient())
+            {
+                const auto referencedInstances = value.value<QVector<QObject*>>();
+
+                for (QObject* referencedInstance : referencedInstances)
+                    unite(instance, referencedInstance);
+            }
+            else
+            {
+                unite(instance, value.value<QObject*>());
+            }
+        }
+    }
+
+    std::vector<Component> components;
+    QHash<QObject*, size_t> componentIndexes;
+
+    int age = 0;
+    for (QObject* instance : m_lru)
+    {
+        QObject* root = findRoot(instance);
+        auto it = componentIndexes.find(root);
+
+        if (it == std::end(componentIndexes))
+        {
+            it = componentIndexes.insert(root, components.size());
+            components.emplace_back();
+        }
+
+        Component& component = components[*it];
+        const Entry& entry = m_cache.at(instance);
+
+        component.instances.push_back(instance);
+        component.age = age++;
+
+        if (entry.pinCount > 0 || m_modifiedInstances.contains(instance) ||
+            instance->parent() != nullptr)
+        {
+            component.isKept = true;
+        }
+    }
+
+    return components;
+}
+
+void QOrmEntityInstanceCachePrivate::evict(const Component& component)
+{
+    for (QObject* instance : component.instances)
+    {
+        instance->disconnect(this);
+        remove(instance);
+        delete instance;
+    }
+}
+
+void QOrmEntityInstanceCachePrivate::trim(int targetSize)
+{
+    std::vector<Component> evictableComponents = components();
+
+    evictableComponents.erase(std::remove_if(std::begin(evictableComponents),
+                                             std::end(evictableComponents),
+                                             [](const Component& component) {
+                                                 return component.isKept;
+                                             }),
+                              std::end(evictableComponents));
+
+    std::sort(std::begin(evictableComponents),
+              std::end(evictableComponents),
+              [](const Component& lhs, const Component& rhs) { return lhs.age < rhs.age; });
+
+    for (const Component& component : evictableComponents)
+    {
+        if (static_cast<int>(m_cache.size()) <= targetSize)
+            break;
+
+        evict(component);
+    }
+}
+
 QOrmEntityInstanceCache::QOrmEntityInstanceCache()
     : d{new QOrmEntityInstanceCachePrivate}
 {
@@ -58,23 +250,36 @@ QOrmEntityInstanceCache::QOrmEntityInstanceCache()
 
 QOrmEntityInstanceCache::~QOrmEntityInstanceCache()
 {
-    for (auto it = std::begin(d->m_cache); it != std::end(d->m_cache); ++it)
+    // the cache owns its instances, pinned or not
+    for (auto& [instance, entry] : d->m_cache)
     {
-        it.key()->disconnect(d.get());
-        delete it.key();
-    }
+        Q_UNUSED(entry)
 
-    d->m_cache.clear();
+        instance->disconnect(d.get());
+        delete instance;
+    }
 }
 
 QObject* QOrmEntityInstanceCache::get(const QOrmMetadata& meta, const QVariant& objectId)
 {
-    return d->m_byObjectId.value(qMakePair(meta.className(), objectId), nullptr);
+    QObject* instance = d->m_byObjectId.value(qMakePair(meta.className(), objectId), nullptr);
+
+    if (instance != nullptr)
+    {
+        d->touch(d->m_cache.at(instance));
+        ++d->m_hitCount;
+    }
+    else
+    {
+        ++d->m_missCount;
+    }
+
+    return instance;
 }
 
 bool QOrmEntityInstanceCache::contains(const QObject* instance) const
 {
-    return d->m_cache.contains(const_cast<QObject*>(instance));
+    return d->m_cache.find(const_cast<QObject*>(instance)) != std::end(d->m_cache);
 }
 
 void QOrmEntityInstanceCache::insert(const QOrmMetadata& metadata, QObject* instance)
@@ -82,25 +287,53 @@ void QOrmEntityInstanceCache::insert(const QOrmMetadata& metadata, QObject* inst
     Q_ASSERT(metadata.objectIdMapping() != nullptr);
     Q_ASSERT(instance != nullptr);
 
-    if (d->m_cache.contains(instance))
+    if (contains(instance))
         return;
 
     auto objectId =
         qMakePair(metadata.className(), QOrmPrivate::objectIdPropertyValue(instance, metadata));
 
-    d->m_cache.insert(instance, objectId);
+    auto lruPosition = d->m_lru.insert(std::end(d->m_lru), instance);
+    d->m_cache.emplace(instance,
+                       QOrmEntityInstanceCachePrivate::Entry{objectId, metadata, lruPosition});
     d->m_byObjectId.insert(objectId, instance);
+
+    QObject::connect(instance,
+                     &QObject::destroyed,
+                     d.get(),
+                     &QOrmEntityInstanceCachePrivate::onEntityInstanceDestroyed);
 }
 
 QObject* QOrmEntityInstanceCache::take(QObject* instance)
 {
-    d->m_byObjectId.remove(d->m_cache[instance]);
-    d->m_modifiedInstances.remove(instance);
-    d->m_cache.remove(instance);
+    if (contains(instance))
+    {
+        instance->disconnect(d.get());
+        d->remove(instance);
+    }
 
     return instance;
 }
 
+std::vector<std::pair<QObject*, QOrmMetadata>> QOrmEntityInstanceCache::takeAll()
+{
+    std::vector<std::pair<QObject*, QOrmMetadata>> instances;
+    instances.reserve(d->m_cache.size());
+
+    for (QObject* instance : d->m_lru)
+    {
+        instance->disconnect(d.get());
+        instances.emplace_back(instance, d->m_cache.at(instance).metadata);
+    }
+
+    d->m_cache.clear();
+    d->m_byObjectId.clear();
+    d->m_modifiedInstances.clear();
+    d->m_lru.clear();
+
+    return instances;
+}
+
 void QOrmEntityInstanceCache::finalize(const QOrmMetadata& metadata, QObject* instance)
 {
     for (const QOrmPropertyMapping& mapping : metadata.propertyMappings())
@@ -116,6 +349,11 @@ void QOrmEntityInstanceCache::finalize(const QOrmMetadata& metadata, QObject* in
 
         QObject::connect(instance, notifySignal, d.get(), slot);
     }
+
+    auto it = d->m_cache.find(instance);
+
+    if (it != std::end(d->m_cache))
+        d->recordPersistedValues(instance, it->second);
 }
 
 bool QOrmEntityInstanceCache::isModified(const QObject* instance) const
@@ -123,9 +361,162 @@ bool QOrmEntityInstanceCache::isModified(const QObject* instance) const
     return d->m_modifiedInstances.contains(instance);
 }
 
+void QOrmEntityInstanceCache::markModified(const QObject* instance)
+{
+    if (contains(instance))
+        d->m_modifiedInstances.insert(instance);
+}
+
 void QOrmEntityInstanceCache::markUnmodified(const QObject* instance) const
 {
     d->m_modifiedInstances.remove(instance);
+
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    if (it != std::end(d->m_cache))
+        d->recordPersistedValues(it->first, it->second);
+}
+
+QVector<QVariant> QOrmEntityInstanceCache::persistedValues(const QObject* instance) const
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    return it != std::end(d->m_cache) ? it->second.persistedValues : QVector<QVariant>{};
+}
+
+void QOrmEntityInstanceCache::markStale(const QObject* instance)
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    if (it != std::end(d->m_cache))
+        it->second.isStale = true;
+}
+
+void QOrmEntityInstanceCache::markStale(const QOrmMetadata& entity)
+{
+    for (auto& [instance, entry] : d->m_cache)
+    {
+        Q_UNUSED(instance)
+
+        if (entry.metadata.className() == entity.className())
+            entry.isStale = true;
+    }
+}
+
+void QOrmEntityInstanceCache::markAllStale()
+{
+    for (auto& [instance, entry] : d->m_cache)
+    {
+        Q_UNUSED(instance)
+        entry.isStale = true;
+    }
+}
+
+void QOrmEntityInstanceCache::markUpToDate(const QObject* instance)
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    if (it != std::end(d->m_cache))
+        it->second.isStale = false;
+}
+
+bool QOrmEntityInstanceCache::isStale(const QObject* instance) const
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    return it != std::end(d->m_cache) && it->second.isStale;
+}
+
+int QOrmEntityInstanceCache::size() const
+{
+    return static_cast<int>(d->m_cache.size());
+}
+
+qint64 QOrmEntityInstanceCache::hitCount() const
+{
+    return d->m_hitCount;
+}
+
+qint64 QOrmEntityInstanceCache::missCount() const
+{
+    return d->m_missCount;
+}
+
+void QOrmEntityInstanceCache::resetCounters()
+{
+    d->m_hitCount = 0;
+    d->m_missCount = 0;
+}
+
+int QOrmEntityInstanceCache::maximumSize() const
+{
+    return d->m_maximumSize;
+}
+
+void QOrmEntityInstanceCache::setMaximumSize(int maximumSize)
+{
+    d->m_maximumSize = qMax(0, maximumSize);
+}
+
+void QOrmEntityInstanceCache::pin(const QObject* instance)
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    if (it != std::end(d->m_cache))
+        ++it->second.pinCount;
+}
+
+void QOrmEntityInstanceCache::unpin(const QObject* instance)
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    if (it != std::end(d->m_cache) && it->second.pinCount > 0)
+        --it->second.pinCount;
+}
+
+bool QOrmEntityInstanceCache::isPinned(const QObject* instance) const
+{
+    auto it = d->m_cache.find(const_cast<QObject*>(instance));
+
+    return it != std::end(d->m_cache) && it->second.pinCount > 0;
+}
+
+bool QOrmEntityInstanceCache::evict(QObject* instance)
+{
+    if (!contains(instance))
+        return false;
+
+    for (const QOrmEntityInstanceCachePrivate::Component& component : d->components())
+    {
+        if (component.instances.contains(instance))
+        {
+            if (component.isKept)
+                return false;
+
+            d->evict(component);
+            return true;
+        }
+    }
+
+    Q_ORM_UNEXPECTED_STATE;
+}
+
+void QOrmEntityInstanceCache::clear()
+{
+    for (const QOrmEntityInstanceCachePrivate::Component& component : d->components())
+    {
+        if (!component.isKept)
+            d->evict(component);
+    }
+}
+
+void QOrmEntityInstanceCache::trim()
+{
+    if (d->m_maximumSize == 0 || size() <= d->m_maximumSize)
+        return;
+
+    // trim below the limit to avoid scanning the cache on every subsequent call
+    d->trim(d->m_maximumSize - d->m_maximumSize / 4);
 }
 
 QT_END_NAMESPACE
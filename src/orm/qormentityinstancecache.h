@@ -23,12 +23,17 @@
 
 #include <QtCore/qglobal.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
 #include <QtOrm/qormglobal.h>
+#include <QtOrm/qormmetadata.h>
+
+#include <utility>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
 class QOrmEntityInstanceCachePrivate;
-class QOrmMetadata;
 
 class Q_ORM_EXPORT QOrmEntityInstanceCache
 {
@@ -42,10 +47,57 @@ public:
     bool contains(const QObject* instance) const;
     void insert(const QOrmMetadata& meta, QObject* instance);
     QObject* take(QObject* instance);
+    // removes all instances without deleting them, least recently used first
+    std::vector<std::pair<QObject*, QOrmMetadata>> takeAll();
 
+    // Starts tracking the modifications of the instance and records its values as persisted
     void finalize(const QOrmMetadata& metadata, QObject* instance);
     bool isModified(const QObject* instance) const;
+    void markModified(const QObject* instance);
+    // Also records the current values as persisted, like finalize()
     void markUnmodified(const QObject* instance) const;
+    // The values of the mapped properties as last read from or written to the database, in the
+    // order of the property mappings. Transient properties are null. Empty if the instance is not
+    // cached or has not been finalized.
+    Q_REQUIRED_RESULT
+    QVector<QVariant> persistedValues(const QObject* instance) const;
+
+    // A stale instance has been changed in the database by another writer. It is refreshed
+    // the next time it is read unless it has unsaved changes.
+    void markStale(const QObject* instance);
+    void markStale(const QOrmMetadata& entity);
+    void markAllStale();
+    void markUpToDate(const QObject* instance);
+    Q_REQUIRED_RESULT
+    bool isStale(const QObject* instance) const;
+
+    Q_REQUIRED_RESULT
+    int size() const;
+
+    // lookups by get() that found or did not find an instance
+    Q_REQUIRED_RESULT
+    qint64 hitCount() const;
+    Q_REQUIRED_RESULT
+    qint64 missCount() const;
+    void resetCounters();
+
+    Q_REQUIRED_RESULT
+    int maximumSize() const;
+    void setMaximumSize(int maximumSize);
+
+    void pin(const QObject* instance);
+    void unpin(const QObject* instance);
+    Q_REQUIRED_RESULT
+    bool isPinned(const QObject* instance) const;
+
+    // Delete cached instances with the instances they reference or are referenced by, unless one
+    // of them has unsaved changes, is pinned or is owned by a parent object. evict() returns false
+    // if the instance is not cached or has to be kept.
+    bool evict(QObject* instance);
+    void clear();
+    // Deletes the least recently used instances without unsaved changes, pins or parent objects
+    // until the cache is below its maximum size. Pointers to them held elsewhere become dangling.
+    void trim();
 
 private:
     QScopedPointer<QOrmEntityInstanceCachePrivate> d;
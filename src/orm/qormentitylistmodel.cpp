@@ -57,4 +57,63 @@ void QOrmEntityListModelBase::setOrder(QVariantList order)
     }
 }
 
+int QOrmEntityListModelBase::pageSize() const
+{
+    return m_pageSize;
+}
+
+void QOrmEntityListModelBase::setPageSize(int pageSize)
+{
+    pageSize = qMax(0, pageSize);
+
+    if (m_pageSize != pageSize)
+    {
+        m_pageSize = pageSize;
+        Q_EMIT pageSizeChanged();
+        onPageSizeChanged();
+    }
+}
+
+int QOrmEntityListModelBase::totalCount() const
+{
+    return m_totalCount;
+}
+
+void QOrmEntityListModelBase::setTotalCount(int totalCount)
+{
+    if (m_totalCount != totalCount)
+    {
+        m_totalCount = totalCount;
+        Q_EMIT totalCountChanged();
+    }
+}
+
+bool QOrmEntityListModelBase::isAsynchronous() const
+{
+    return m_isAsynchronous;
+}
+
+void QOrmEntityListModelBase::setAsynchronous(bool isAsynchronous)
+{
+    if (m_isAsynchronous != isAsynchronous)
+    {
+        m_isAsynchronous = isAsynchronous;
+        Q_EMIT asynchronousChanged();
+    }
+}
+
+bool QOrmEntityListModelBase::isLoading() const
+{
+    return m_isLoading;
+}
+
+void QOrmEntityListModelBase::setLoading(bool isLoading)
+{
+    if (m_isLoading != isLoading)
+    {
+        m_isLoading = isLoading;
+        Q_EMIT loadingChanged();
+    }
+}
+
 QT_END_NAMESPACE
@@ -24,10 +24,13 @@
 #include <QtCore/qabstractitemmodel.h>
 #include <QtCore/qbytearray.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qset.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qvector.h>
 
 #include <QtOrm/private/qormglobal_p.h>
+#include <QtOrm/qormentityinstancecache.h>
 #include <QtOrm/qormglobal.h>
 #include <QtOrm/qormmetadata.h>
 #include <QtOrm/qormmetadatacache.h>
@@ -37,6 +40,11 @@
 
 #include <QDebug>
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class Q_ORM_EXPORT QOrmEntityListModelBase : public QAbstractListModel
@@ -45,6 +53,11 @@ class Q_ORM_EXPORT QOrmEntityListModelBase : public QAbstractListModel
 
     Q_PROPERTY(QVariantMap filter READ filter WRITE setFilter NOTIFY filterChanged)
     Q_PROPERTY(QVariantList order READ order WRITE setOrder NOTIFY orderChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+    Q_PROPERTY(bool asynchronous READ isAsynchronous WRITE setAsynchronous NOTIFY
+                   asynchronousChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
 
 public:
     QOrmEntityListModelBase(QObject* parent = nullptr);
@@ -55,6 +68,16 @@ public:
     QVariantList order() const;
     void setOrder(QVariantList order);
 
+    int pageSize() const;
+    void setPageSize(int pageSize);
+
+    int totalCount() const;
+
+    bool isAsynchronous() const;
+    void setAsynchronous(bool isAsynchronous);
+
+    bool isLoading() const;
+
 public Q_SLOTS:
     virtual QObject* at(int index) const = 0;
     virtual int indexOf(QObject* entityInstance) const = 0;
@@ -68,16 +91,30 @@ Q_SIGNALS:
     void entityInstanceCreated();
     void entityInstanceRemoved();
     void filterChanged();
-    void orderChanged();    
+    void orderChanged();
+    void pageSizeChanged();
+    void totalCountChanged();
+    void asynchronousChanged();
+    void loadingChanged();
 
 protected Q_SLOTS:
     virtual void onFilterChanged() = 0;
     virtual void onOrderChanged() = 0;
+    virtual void onPageSizeChanged() = 0;
     virtual void readData() = 0;
 
 protected:
+    void setTotalCount(int totalCount);
+    void setLoading(bool isLoading);
+
     QVariantMap m_filter;
     QVariantList m_order;
+    // number of rows read at once, 0 reads all rows
+    int m_pageSize{0};
+    int m_totalCount{0};
+    // queries run on a worker thread of the session
+    bool m_isAsynchronous{false};
+    bool m_isLoading{false};
 };
 
 template<typename T>
@@ -85,22 +122,52 @@ class QOrmEntityListModel : public QOrmEntityListModelBase
 {
 public:
     QOrmEntityListModel(QOrmSession& session, QObject* parent = nullptr)
+        : QOrmEntityListModel{session, 0, parent}
+    {
+    }
+
+    QOrmEntityListModel(QOrmSession& session, int pageSize, QObject* parent = nullptr)
+        : QOrmEntityListModel{session, pageSize, false, parent}
+    {
+    }
+
+    QOrmEntityListModel(QOrmSession& session,
+                        int pageSize,
+                        bool isAsynchronous,
+                        QObject* parent = nullptr)
         : QOrmEntityListModelBase{parent}
         , m_session{session}
     {
+        m_pageSize = qMax(0, pageSize);
+        m_isAsynchronous = isAsynchronous;
         readData();
 
+        // rows follow the changes made through the session
+        m_entityChangeListenerId = m_session.addEntityChangeListener<T>(
+            this, [this](QOrm::Operation operation, QObject* instance) {
+                onEntityInstanceChanged(operation, qobject_cast<T*>(instance));
+            });
+
         int roleIndex = Qt::UserRole;
 
         for (const QOrmPropertyMapping& propertyMapping :
              m_session.metadataCache()->get<T>().propertyMappings())
         {
-            m_roles.insert(std::make_pair(roleIndex, propertyMapping));
+            QByteArray typeName = propertyMapping.dataTypeName().toUtf8();
+            m_roles.push_back(Role{propertyMapping.qMetaProperty(),
+                                   typeName.startsWith("QVector<") && typeName.endsWith("*>")});
             m_roleNames.insert(roleIndex, propertyMapping.classPropertyName().toUtf8());
             roleIndex++;
         }
     }
 
+    ~QOrmEntityListModel() override
+    {
+        m_session.removeEntityChangeListener(m_entityChangeListenerId);
+        cancelBackgroundReads();
+        replaceData({});
+    }
+
     QObject* at(int index) const override
     {
         return index >= 0 && index < m_data.size() ? m_data[index] : nullptr;
@@ -108,15 +175,19 @@ public:
 
     int indexOf(QObject* instance) const override
     {
-        for (int i = 0; i < m_data.size(); ++i)
+        // the row index is rebuilt lazily after the rows have been replaced
+        if (m_isRowIndexOutdated)
         {
-            if (static_cast<void*>(m_data[i]) == static_cast<void*>(instance))
-            {
-                return i;
-            }
+            m_rowIndex.clear();
+            m_rowIndex.reserve(m_data.size());
+
+            for (int i = 0; i < m_data.size(); ++i)
+                m_rowIndex.insert(m_data[i], i);
+
+            m_isRowIndexOutdated = false;
         }
 
-        return -1;
+        return m_rowIndex.value(instance, -1);
     }
 
     QObject* create(QVariantMap properties) override
@@ -131,7 +202,7 @@ public:
                 m_session.metadataCache()->get<T>().classPropertyMapping(propertyName);
             Q_ASSERT(propertyMapping != nullptr);
 
-            instance->setProperty(propertyName.toUtf8().data(), propertyValue);
+            propertyMapping->write(instance, propertyValue);
 
             // Update back reference if any
             if (propertyMapping->isReference() && !propertyMapping->isTransient())
@@ -146,12 +217,11 @@ public:
                 {
                     QObject* referencedInstance = propertyValue.value<QObject*>();
                     auto backReferenceContainer =
-                        QOrmPrivate::propertyValue(referencedInstance,
-                                                   backReference->classPropertyName())
+                        QOrmPrivate::propertyValue(referencedInstance, *backReference)
                             .value<QVector<QObject*>>();
                     backReferenceContainer.push_back(instance);
                     if (!QOrmPrivate::setPropertyValue(referencedInstance,
-                                                       backReference->classPropertyName(),
+                                                       *backReference,
                                                        QVariant::fromValue(backReferenceContainer)))
                     {
                         qFatal("Unable to update back-reference");
@@ -160,55 +230,33 @@ public:
             }
         }
 
-        if (m_session.merge(instance))
+        // A failed merge has rolled back its own transaction, and the session has dropped the
+        // instance
+        if (!m_session.merge(instance))
         {
-            Q_EMIT entityInstanceCreated();
-            read();
-            return instance;
+            removeBackReferences(instance);
+            delete instance;
+            return nullptr;
         }
 
-        delete instance;
-        return nullptr;
+        // flush a merge deferred by an active transaction, the row is inserted when the instance
+        // is written. If the flush fails, the merge stays pending in the session, which still
+        // refers to the instance: it is written by the next flush or restored by the rollback.
+        if (!m_session.flush())
+            return nullptr;
+
+        Q_EMIT entityInstanceCreated();
+        return instance;
     }
 
     bool remove(QObject* entityInstance) override
     {
-        // update back reference
-
-        for (const QOrmPropertyMapping& propertyMapping :
-             m_session.metadataCache()->get<T>().propertyMappings())
-        {
-            if (propertyMapping.isReference() && !propertyMapping.isTransient())
-            {
-                QObject* referencedInstance =
-                    QOrmPrivate::propertyValue(entityInstance, propertyMapping).value<QObject*>();
-                const QOrmPropertyMapping* backReference =
-                    QOrmPrivate::backReference(propertyMapping);
-
-                Q_ASSERT(backReference != nullptr);
-
-                if (backReference->dataTypeName().startsWith("QVector<") &&
-                    backReference->dataTypeName().endsWith("*>"))
-                {
-                    auto backReferenceContainer =
-                        QOrmPrivate::propertyValue(referencedInstance,
-                                                   backReference->classPropertyName())
-                            .value<QVector<QObject*>>();
-                    backReferenceContainer.removeAll(entityInstance);
-                    if (!QOrmPrivate::setPropertyValue(referencedInstance,
-                                                       backReference->classPropertyName(),
-                                                       QVariant::fromValue(backReferenceContainer)))
-                    {
-                        qFatal("Unable to update back-reference");
-                    }
-                }
-            }
-        }
+        removeBackReferences(entityInstance);
 
+        // the row is removed when the session removes the instance
         if (m_session.remove(qobject_cast<T*>(entityInstance)))
         {
             Q_EMIT entityInstanceRemoved();
-            read();
             return true;
         }
 
@@ -217,12 +265,7 @@ public:
 
     bool removeAt(int index) override
     {
-        if (index >= 0 && index <= m_data.size() && m_session.remove(m_data[index]))
-        {
-            read();
-            return true;
-        }
-        return false;
+        return index >= 0 && index < m_data.size() && remove(m_data[index]);
     }
 
     bool update(QObject* instance) override {
@@ -230,37 +273,85 @@ public:
         if (!t)
             return false;
         if (m_session.merge(t)) {
-            int row = indexOf(instance);
-            Q_ASSERT(row >= 0);
-            emit dataChanged(index(row), index(row));
+            // a merge deferred by an active transaction is not published until it is flushed
+            onEntityInstanceChanged(QOrm::Operation::Update, t);
             return true;
         }
         return false;
     }
 
-    void read() override
+    void read() override { readData(); }
+
+    int rowCount(const QModelIndex& = QModelIndex{}) const { return m_data.size(); }
+
+    bool canFetchMore(const QModelIndex& parent) const override
     {
-        Q_EMIT beginResetModel();
-        readData();
-        Q_EMIT endResetModel();
+        return !parent.isValid() && m_canFetchMore && m_fetchReadId < 0;
     }
 
-    int rowCount(const QModelIndex& = QModelIndex{}) const { return m_data.size(); }
+    void fetchMore(const QModelIndex& parent) override
+    {
+        if (!canFetchMore(parent))
+            return;
+
+        const T* lastInstance = m_data.isEmpty() ? nullptr : m_data.back();
+        auto query = pageQuery(lastInstance, m_data.size());
+
+        if (m_isAsynchronous)
+        {
+            m_fetchReadId = m_session.executeInBackground(
+                query.build(QOrm::Operation::Read),
+                this,
+                [this](QOrmQueryResult<QObject> result) {
+                    m_fetchReadId = -1;
+
+                    if (result.error().type() == QOrm::ErrorType::None)
+                        appendPage(QOrmQueryResult<T>{std::move(result)}.takeVector());
+                    else
+                        qWarning() << "QtOrm: Unable to read the next page:" << result.error();
+
+                    updateLoading();
+                });
+
+            updateLoading();
+            return;
+        }
+
+        appendPage(query.select().takeVector());
+    }
+
+    void appendPage(QVector<T*> page)
+    {
+        m_canFetchMore = page.size() == m_pageSize;
+
+        if (page.isEmpty())
+            return;
+
+        beginInsertRows({}, m_data.size(), m_data.size() + page.size() - 1);
+
+        for (const T* instance : qAsConst(page))
+            m_session.entityInstanceCache()->pin(instance);
+
+        int first = m_data.size();
+        m_data += page;
+        updateRowIndex(first, m_data.size());
+        endInsertRows();
+    }
 
     QHash<int, QByteArray> roleNames() const { return m_roleNames; }
 
     QVariant data(const QModelIndex& index, int role) const
     {
-        if (index.row() >= 0 && index.row() < m_data.size())
+        size_t roleIndex = static_cast<size_t>(role - Qt::UserRole);
+
+        if (index.row() >= 0 && index.row() < m_data.size() && role >= Qt::UserRole &&
+            roleIndex < m_roles.size())
         {
-            const QOrmPropertyMapping& propertyMapping = m_roles.at(role);
+            const Role& roleProperty = m_roles[roleIndex];
 
-            QVariant propertyValue =
-                m_data[index.row()]->property(propertyMapping.classPropertyName().toUtf8().data());
+            QVariant propertyValue = roleProperty.property.read(m_data[index.row()]);
 
-            if (propertyValue.type() == QVariant::UserType &&
-                QString{propertyValue.typeName()}.startsWith("QVector<") &&
-                QString{propertyValue.typeName()}.endsWith("*>"))
+            if (roleProperty.isEntityList)
             {
                 QVariantList list;
 
@@ -278,11 +369,276 @@ public:
     }
 
 private:
-    void onFilterChanged() override { readData(); }
+    // While all rows are resident, a new order and a narrower filter are applied in memory
+    void onFilterChanged() override
+    {
+        if (isDataResident() && isNarrowerFilter(m_filter, *m_dataFilter))
+        {
+            filterData();
+            return;
+        }
+
+        readData();
+    }
+
+    void onOrderChanged() override
+    {
+        if (isDataResident())
+        {
+            sortData();
+            return;
+        }
+
+        readData();
+    }
 
-    void onOrderChanged() override { readData(); }
+    void onPageSizeChanged() override { readData(); }
+
+    // Handles an instance written, removed or restored by the session. Handling the same change
+    // twice has no effect.
+    void onEntityInstanceChanged(QOrm::Operation operation, T* instance)
+    {
+        Q_ASSERT(instance != nullptr);
+
+        int row = indexOf(instance);
+
+        if (operation == QOrm::Operation::Delete)
+        {
+            if (row >= 0)
+            {
+                removeInstanceAt(row);
+                setTotalCount(m_totalCount - 1);
+            }
+            else if (m_canFetchMore && matchesFilter(instance))
+            {
+                // the row has not been read yet
+                setTotalCount(m_totalCount - 1);
+            }
+
+            return;
+        }
+
+        if (row < 0)
+        {
+            // Unless all rows are read, an updated instance may have been counted already
+            insertInstance(instance, operation == QOrm::Operation::Create || !m_canFetchMore);
+        }
+        else if (!matchesFilter(instance))
+        {
+            removeInstanceAt(row);
+            setTotalCount(m_totalCount - 1);
+        }
+        else
+        {
+            Q_EMIT dataChanged(index(row), index(row));
+            repositionInstanceAt(row);
+        }
+    }
 
     void readData() override
+    {
+        if (m_isAsynchronous)
+        {
+            readDataInBackground();
+            return;
+        }
+
+        if (m_pageSize == 0)
+        {
+            m_canFetchMore = false;
+            applyData(buildQuery().select().takeVector());
+            m_dataFilter = m_filter;
+            setTotalCount(m_data.size());
+            return;
+        }
+
+        QVector<T*> page = pageQuery(nullptr, 0).select().takeVector();
+
+        m_canFetchMore = page.size() == m_pageSize;
+        applyData(std::move(page));
+        m_dataFilter = m_filter;
+
+        int totalCount = buildQuery().count();
+        setTotalCount(totalCount < 0 ? m_data.size() : totalCount);
+    }
+
+    // Superseded reads are cancelled. Until the new rows arrive, the model shows the previous ones.
+    void readDataInBackground()
+    {
+        cancelBackgroundReads();
+        m_canFetchMore = false;
+        m_dataFilter.reset();
+
+        QOrmQuery query = m_pageSize == 0 ? buildQuery().build(QOrm::Operation::Read)
+                                          : pageQuery(nullptr, 0).build(QOrm::Operation::Read);
+
+        m_readId = m_session.executeInBackground(
+            query, this, [this](QOrmQueryResult<QObject> result) {
+                m_readId = -1;
+
+                if (result.error().type() == QOrm::ErrorType::None)
+                {
+                    QVector<T*> data = QOrmQueryResult<T>{std::move(result)}.takeVector();
+
+                    m_canFetchMore = m_pageSize > 0 && data.size() == m_pageSize;
+                    applyData(std::move(data));
+                    m_dataFilter = m_filter;
+
+                    if (m_pageSize == 0)
+                        setTotalCount(m_data.size());
+                }
+                else
+                {
+                    qWarning() << "QtOrm: Unable to read entity instances:" << result.error();
+                }
+
+                updateLoading();
+            });
+
+        if (m_pageSize > 0)
+        {
+            m_countReadId = m_session.executeInBackground(
+                buildQuery().build(QOrm::Operation::Count),
+                this,
+                [this](QOrmQueryResult<QObject> result) {
+                    m_countReadId = -1;
+
+                    if (result.error().type() == QOrm::ErrorType::None)
+                        setTotalCount(result.lastInsertedId().toInt());
+
+                    updateLoading();
+                });
+        }
+
+        updateLoading();
+    }
+
+    void cancelBackgroundReads()
+    {
+        for (int* id : {&m_readId, &m_countReadId, &m_fetchReadId})
+        {
+            if (*id >= 0)
+                m_session.cancelBackgroundRead(*id);
+
+            *id = -1;
+        }
+
+        updateLoading();
+    }
+
+    void updateLoading() { setLoading(m_readId >= 0 || m_countReadId >= 0 || m_fetchReadId >= 0); }
+
+    // All rows matching the filter the data has been read with are in the model
+    bool isDataResident() const
+    {
+        return m_dataFilter.has_value() && !m_canFetchMore && m_readId < 0 && m_fetchReadId < 0;
+    }
+
+    // The filter is a conjunction of equalities, so adding terms selects a subset of the rows.
+    // References are compared by object ID in the database and cannot be checked in memory.
+    static bool isNarrowerFilter(const QVariantMap& filter, const QVariantMap& previousFilter)
+    {
+        for (auto it = std::cbegin(previousFilter); it != std::cend(previousFilter); ++it)
+        {
+            auto filterIt = filter.find(it.key());
+
+            if (filterIt == std::cend(filter) || *filterIt != it.value())
+                return false;
+        }
+
+        for (const QVariant& value : filter)
+        {
+            if (QMetaType::typeFlags(value.userType()).testFlag(QMetaType::PointerToQObject))
+                return false;
+        }
+
+        return true;
+    }
+
+    void filterData()
+    {
+        QVector<T*> data;
+        data.reserve(m_data.size());
+
+        auto properties = filterProperties();
+
+        for (T* instance : qAsConst(m_data))
+        {
+            if (matchesFilter(instance, properties))
+                data.push_back(instance);
+        }
+
+        applyData(std::move(data));
+        m_dataFilter = m_filter;
+        setTotalCount(m_data.size());
+    }
+
+    // Sorts the rows with the order keys, keeping the previous order of equal rows
+    void sortData()
+    {
+        auto keys = sortProperties();
+        QVector<T*> data = m_data;
+
+        std::stable_sort(std::begin(data),
+                         std::end(data),
+                         [this, &keys](const T* lhs, const T* rhs) {
+                             return lessThan(lhs, rhs, keys);
+                         });
+
+        if (data == m_data)
+            return;
+
+        Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        QHash<const T*, int> newRows;
+        newRows.reserve(data.size());
+
+        for (int i = 0; i < data.size(); ++i)
+            newRows.insert(data[i], i);
+
+        const QModelIndexList oldIndexes = persistentIndexList();
+        QModelIndexList newIndexes;
+        newIndexes.reserve(oldIndexes.size());
+
+        for (const QModelIndex& oldIndex : oldIndexes)
+            newIndexes.push_back(index(newRows.value(m_data[oldIndex.row()]), oldIndex.column()));
+
+        m_data = std::move(data);
+        updateRowIndex(0, m_data.size());
+
+        changePersistentIndexList(oldIndexes, newIndexes);
+        Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    // Reads the page after the given instance. Without an explicit order, rows are paged by
+    // object ID, so that a page is found with an index lookup instead of skipping the previous
+    // rows. Otherwise, the object ID breaks ties so that the pages do not overlap.
+    QOrmQueryBuilder<T> pageQuery(const T* lastInstance, int offset)
+    {
+        const QOrmMetadata& entity = m_session.metadataCache()->get<T>();
+        Q_ASSERT(entity.objectIdMapping() != nullptr);
+
+        QByteArray objectIdProperty = entity.objectIdMapping()->classPropertyName().toUtf8();
+        QOrmClassProperty objectId{objectIdProperty.data()};
+
+        auto query = buildQuery();
+
+        if (orderKeys().empty())
+        {
+            if (lastInstance != nullptr)
+                query.filter(objectId > QOrmPrivate::objectIdPropertyValue(lastInstance, entity));
+        }
+        else
+        {
+            query.offset(offset);
+        }
+
+        query.order(objectId).limit(m_pageSize);
+
+        return query;
+    }
+
+    QOrmQueryBuilder<T> buildQuery()
     {
         std::optional<QOrmFilterExpression> filterExpression;
         std::vector<QOrmOrder> order;
@@ -308,6 +664,16 @@ private:
             query.filter(*filterExpression);
         }
 
+        for (const auto& [property, direction] : orderKeys())
+            query.order(QOrmClassProperty{property.data()}, direction);
+
+        return query;
+    }
+
+    std::vector<std::pair<QByteArray, Qt::SortOrder>> orderKeys() const
+    {
+        std::vector<std::pair<QByteArray, Qt::SortOrder>> keys;
+
         for (const QVariant& orderItem : m_order)
         {
             if (orderItem.type() == QVariant::Map)
@@ -315,15 +681,11 @@ private:
                 QVariantMap orderItemMap = orderItem.toMap();
 
                 for (auto it = std::cbegin(orderItemMap); it != std::cend(orderItemMap); ++it)
-                {
-                    query.order(QOrmClassProperty{it.key().toUtf8().data()},
-                                it.value().value<Qt::SortOrder>());
-                }
+                    keys.emplace_back(it.key().toUtf8(), it.value().value<Qt::SortOrder>());
             }
             else if (orderItem.type() == QVariant::String)
             {
-                query.order(QOrmClassProperty{orderItem.toString().toUtf8().data()},
-                            Qt::AscendingOrder);
+                keys.emplace_back(orderItem.toString().toUtf8(), Qt::AscendingOrder);
             }
             else
             {
@@ -331,14 +693,430 @@ private:
             }
         }
 
-        m_data = query.select().toVector();
+        return keys;
+    }
+
+    // Removes the instance from the back-references of the instances it refers to
+    void removeBackReferences(QObject* entityInstance)
+    {
+        for (const QOrmPropertyMapping& propertyMapping :
+             m_session.metadataCache()->get<T>().propertyMappings())
+        {
+            if (!propertyMapping.isReference() || propertyMapping.isTransient())
+                continue;
+
+            QObject* referencedInstance =
+                QOrmPrivate::propertyValue(entityInstance, propertyMapping).value<QObject*>();
+            const QOrmPropertyMapping* backReference = QOrmPrivate::backReference(propertyMapping);
+
+            Q_ASSERT(backReference != nullptr);
+
+            if (referencedInstance != nullptr &&
+                backReference->dataTypeName().startsWith("QVector<") &&
+                backReference->dataTypeName().endsWith("*>"))
+            {
+                auto backReferenceContainer =
+                    QOrmPrivate::propertyValue(referencedInstance, *backReference)
+                        .value<QVector<QObject*>>();
+                backReferenceContainer.removeAll(entityInstance);
+                if (!QOrmPrivate::setPropertyValue(referencedInstance,
+                                                   *backReference,
+                                                   QVariant::fromValue(backReferenceContainer)))
+                {
+                    qFatal("Unable to update back-reference");
+                }
+            }
+        }
+    }
+
+    // In-memory counterparts of the filter and the order of the query, used to place single
+    // instances without reading the whole list again
+    // The properties are resolved once per pass over the rows, the comparisons read them by index
+    static QMetaProperty metaProperty(const QByteArray& name)
+    {
+        return T::staticMetaObject.property(T::staticMetaObject.indexOfProperty(name.data()));
+    }
+
+    // A reference is compared by the object ID of the referenced instance, as in the database
+    struct FilterProperty
+    {
+        QMetaProperty property;
+        const QOrmPropertyMapping* reference;
+        QVariant value;
+    };
+
+    std::vector<FilterProperty> filterProperties() const
+    {
+        const QOrmMetadata& metadata = m_session.metadataCache()->get<T>();
+        std::vector<FilterProperty> properties;
+
+        for (auto it = std::cbegin(m_filter); it != std::cend(m_filter); ++it)
+        {
+            QMetaProperty property = metaProperty(it.key().toUtf8());
+            const QOrmPropertyMapping* mapping = metadata.classPropertyMapping(it.key());
+
+            if (mapping != nullptr && mapping->isReference() && !mapping->isTransient())
+            {
+                const QObject* referencedInstance = it.value().value<QObject*>();
+                QVariant objectId = referencedInstance == nullptr
+                                        ? QVariant{}
+                                        : QOrmPrivate::objectIdPropertyValue(
+                                              referencedInstance, *mapping->referencedEntity());
+
+                properties.push_back({property, mapping, objectId});
+            }
+            else
+            {
+                properties.push_back({property, nullptr, it.value()});
+            }
+        }
+
+        return properties;
+    }
+
+    std::vector<std::pair<QMetaProperty, Qt::SortOrder>> sortProperties() const
+    {
+        std::vector<std::pair<QMetaProperty, Qt::SortOrder>> properties;
+
+        for (const auto& [property, direction] : orderKeys())
+            properties.emplace_back(metaProperty(property), direction);
+
+        return properties;
+    }
+
+    bool matchesFilter(const T* instance) const
+    {
+        return matchesFilter(instance, filterProperties());
+    }
+
+    bool matchesFilter(const T* instance, const std::vector<FilterProperty>& properties) const
+    {
+        for (const auto& [property, reference, value] : properties)
+        {
+            QVariant instanceValue = reference != nullptr
+                                         ? QOrmPrivate::storedPropertyValue(instance, *reference)
+                                         : property.read(instance);
+
+            if (QOrmPrivate::compareValues(instanceValue, value) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool lessThan(const T* lhs,
+                  const T* rhs,
+                  const std::vector<std::pair<QMetaProperty, Qt::SortOrder>>& keys) const
+    {
+        for (const auto& [property, direction] : keys)
+        {
+            int result = QOrmPrivate::compareValues(property.read(lhs), property.read(rhs));
+
+            if (result != 0)
+                return direction == Qt::AscendingOrder ? result < 0 : result > 0;
+        }
+
+        return false;
+    }
+
+    void insertInstance(T* instance, bool isNewRow = true)
+    {
+        if (!matchesFilter(instance) || indexOf(instance) >= 0)
+            return;
+
+        if (isNewRow)
+            setTotalCount(m_totalCount + 1);
+
+        // without an order, the database returns new rows last
+        auto keys = sortProperties();
+        auto it = std::upper_bound(std::begin(m_data),
+                                   std::end(m_data),
+                                   instance,
+                                   [this, &keys](const T* lhs, const T* rhs) {
+                                       return lessThan(lhs, rhs, keys);
+                                   });
+        int row = static_cast<int>(std::distance(std::begin(m_data), it));
+
+        // an instance after the last read row is read with its page
+        if (row == m_data.size() && m_canFetchMore)
+            return;
+
+        beginInsertRows({}, row, row);
+        m_session.entityInstanceCache()->pin(instance);
+        m_data.insert(row, instance);
+        updateRowIndex(row, m_data.size());
+        endInsertRows();
+    }
+
+    void removeInstanceAt(int row)
+    {
+        beginRemoveRows({}, row, row);
+        m_session.entityInstanceCache()->unpin(m_data[row]);
+
+        if (!m_isRowIndexOutdated)
+            m_rowIndex.remove(m_data[row]);
+
+        m_data.remove(row);
+        updateRowIndex(row, m_data.size());
+        endRemoveRows();
+    }
+
+    void repositionInstanceAt(int row)
+    {
+        auto keys = sortProperties();
+        auto less = [this, &keys](const T* lhs, const T* rhs) { return lessThan(lhs, rhs, keys); };
+        T* instance = m_data[row];
+        int destination = row;
+
+        if (row > 0 && less(instance, m_data[row - 1]))
+        {
+            destination = static_cast<int>(
+                std::distance(std::begin(m_data),
+                              std::upper_bound(std::begin(m_data),
+                                               std::begin(m_data) + row,
+                                               instance,
+                                               less)));
+        }
+        else if (row + 1 < m_data.size() && less(m_data[row + 1], instance))
+        {
+            destination = static_cast<int>(
+                std::distance(std::begin(m_data),
+                              std::upper_bound(std::begin(m_data) + row + 1,
+                                               std::end(m_data),
+                                               instance,
+                                               less)));
+        }
+
+        if (destination == row || destination == row + 1)
+            return;
+
+        if (destination == m_data.size() && m_canFetchMore)
+        {
+            removeInstanceAt(row);
+            return;
+        }
+
+        beginMoveRows({}, row, row, {}, destination);
+        m_data.move(row, destination > row ? destination - 1 : destination);
+        updateRowIndex(qMin(row, destination), qMax(row + 1, destination));
+        endMoveRows();
+    }
+
+    // Updates the row index for the rows in [first, last) after they have been shifted. Other rows
+    // keep their positions, so a single row change only reindexes the rows behind it.
+    void updateRowIndex(int first, int last) const
+    {
+        if (m_isRowIndexOutdated)
+            return;
+
+        for (int i = first; i < last; ++i)
+            m_rowIndex.insert(m_data[i], i);
+    }
+
+    // Replaces the rows with the given instances and emits the removals, moves and insertions
+    // that turn the current rows into the new ones. Falls back to a model reset when the rows
+    // have changed too much for individual signals to pay off.
+    void applyData(QVector<T*> data)
+    {
+        QHash<const T*, int> newRows;
+        newRows.reserve(data.size());
+
+        for (int i = 0; i < data.size(); ++i)
+            newRows.insert(data[i], i);
+
+        QSet<const T*> oldInstances;
+        oldInstances.reserve(m_data.size());
+
+        int removedRanges = 0;
+        std::vector<int> positions;
+
+        for (int i = 0; i < m_data.size(); ++i)
+        {
+            oldInstances.insert(m_data[i]);
+
+            auto it = newRows.find(m_data[i]);
+
+            if (it != std::end(newRows))
+                positions.push_back(*it);
+            else if (i == 0 || newRows.contains(m_data[i - 1]))
+                ++removedRanges;
+        }
+
+        int insertedRanges = 0;
+
+        for (int i = 0; i < data.size(); ++i)
+        {
+            if (!oldInstances.contains(data[i]) &&
+                (i == 0 || oldInstances.contains(data[i - 1])))
+            {
+                ++insertedRanges;
+            }
+        }
+
+        // The rows in the longest increasing subsequence of new positions stay where they are,
+        // all other retained rows are moved
+        std::vector<size_t> tails;
+        std::vector<ptrdiff_t> previous(positions.size(), -1);
+
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            auto it = std::lower_bound(std::begin(tails),
+                                       std::end(tails),
+                                       positions[i],
+                                       [&positions](size_t index, int position) {
+                                           return positions[index] < position;
+                                       });
+
+            if (it != std::begin(tails))
+                previous[i] = static_cast<ptrdiff_t>(*(it - 1));
+
+            if (it == std::end(tails))
+                tails.push_back(i);
+            else
+                *it = i;
+        }
+
+        int movedRows = static_cast<int>(positions.size() - tails.size());
+
+        if (removedRanges + movedRows + insertedRanges > MaximumIncrementalChanges)
+        {
+            beginResetModel();
+            replaceData(std::move(data));
+            endResetModel();
+            return;
+        }
+
+        QOrmEntityInstanceCache* cache = m_session.entityInstanceCache();
+
+        for (const T* instance : data)
+            cache->pin(instance);
+
+        QVector<T*> oldData = m_data;
+
+        for (int last = m_data.size() - 1; last >= 0;)
+        {
+            if (newRows.contains(m_data[last]))
+            {
+                --last;
+                continue;
+            }
+
+            int first = last;
+            while (first > 0 && !newRows.contains(m_data[first - 1]))
+                --first;
+
+            beginRemoveRows({}, first, last);
+            m_data.erase(std::begin(m_data) + first, std::begin(m_data) + last + 1);
+            m_isRowIndexOutdated = true;
+            endRemoveRows();
+
+            last = first - 1;
+        }
+
+        if (movedRows > 0)
+        {
+            QSet<const T*> stationaryInstances;
+
+            for (ptrdiff_t i = tails.empty() ? -1 : static_cast<ptrdiff_t>(tails.back()); i >= 0;
+                 i = previous[static_cast<size_t>(i)])
+            {
+                stationaryInstances.insert(m_data[static_cast<int>(i)]);
+            }
+
+            // Place each moved row right after its predecessor in the new order
+            T* predecessor = nullptr;
+
+            for (T* instance : qAsConst(data))
+            {
+                if (!oldInstances.contains(instance))
+                    continue;
+
+                if (!stationaryInstances.contains(instance))
+                {
+                    int from = m_data.indexOf(instance);
+                    int to = predecessor == nullptr ? 0 : m_data.indexOf(predecessor) + 1;
+
+                    if (to != from)
+                    {
+                        beginMoveRows({}, from, from, {}, to);
+                        m_data.move(from, from < to ? to - 1 : to);
+                        m_isRowIndexOutdated = true;
+                        endMoveRows();
+                    }
+                }
+
+                predecessor = instance;
+            }
+        }
+
+        // The remaining rows are in the new order now, insert the missing ones
+        for (int first = 0; first < data.size();)
+        {
+            if (first < m_data.size() && m_data[first] == data[first])
+            {
+                ++first;
+                continue;
+            }
+
+            int last = first;
+            while (last + 1 < data.size() && !oldInstances.contains(data[last + 1]))
+                ++last;
+
+            beginInsertRows({}, first, last);
+            m_data.insert(first, last - first + 1, nullptr);
+            std::copy(std::begin(data) + first,
+                      std::begin(data) + last + 1,
+                      std::begin(m_data) + first);
+            m_isRowIndexOutdated = true;
+            endInsertRows();
+
+            first = last + 1;
+        }
+
+        for (const T* instance : oldData)
+            cache->unpin(instance);
+    }
+
+    // Instances shown by the model must not be evicted from the session cache
+    void replaceData(QVector<T*> data)
+    {
+        QOrmEntityInstanceCache* cache = m_session.entityInstanceCache();
+
+        for (const T* instance : data)
+            cache->pin(instance);
+
+        for (const T* instance : m_data)
+            cache->unpin(instance);
+
+        m_data = std::move(data);
+        m_isRowIndexOutdated = true;
     }
 
 private:
+    struct Role
+    {
+        QMetaProperty property;
+        bool isEntityList{false};
+    };
+
+    static constexpr int MaximumIncrementalChanges = 64;
+
     QOrmSession& m_session;
     QVector<T*> m_data;
+    // rows after the last read page are available
+    bool m_canFetchMore{false};
+    // IDs of the background reads in progress
+    int m_readId{-1};
+    int m_countReadId{-1};
+    int m_fetchReadId{-1};
+    int m_entityChangeListenerId{-1};
+    // filter of the last completed read, reset while a read is in progress
+    std::optional<QVariantMap> m_dataFilter;
+    mutable QHash<const QObject*, int> m_rowIndex;
+    mutable bool m_isRowIndexOutdated{true};
     QHash<int, QByteArray> m_roleNames;
-    std::unordered_map<int, QOrmPropertyMapping> m_roles;
+    // properties of the roles starting from Qt::UserRole
+    std::vector<Role> m_roles;
 };
 
 QT_END_NAMESPACE
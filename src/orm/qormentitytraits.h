@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef QORMENTITYTRAITS_H
+#define QORMENTITYTRAITS_H
+
+#include <QtOrm/qormglobal.h>
+
+#include <QtCore/qobject.h>
+#include <QtCore/qvariant.h>
+
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+// A property of an entity declared at compile time. The property is read and written by calling
+// its accessors directly instead of through the meta-object system.
+class QOrmColumn
+{
+public:
+    const char* propertyName;
+    // the name of the table field, derived from the property name if null
+    const char* tableFieldName;
+    QVariant (*read)(const QObject* entityInstance);
+    bool (*write)(QObject* entityInstance, const QVariant& value);
+};
+
+namespace QOrmPrivate
+{
+    template<typename MemberFunction>
+    struct ColumnAccessorTraits;
+
+    template<typename C, typename R>
+    struct ColumnAccessorTraits<R (C::*)() const>
+    {
+        using Class = C;
+        using Value = std::decay_t<R>;
+    };
+
+    template<typename C, typename A>
+    struct ColumnAccessorTraits<void (C::*)(A)>
+    {
+        using Class = C;
+        using Value = std::decay_t<A>;
+    };
+
+    template<auto Getter>
+    QVariant readColumn(const QObject* entityInstance)
+    {
+        using Traits = ColumnAccessorTraits<decltype(Getter)>;
+        using Class = typename Traits::Class;
+
+        return QVariant::fromValue((static_cast<const Class*>(entityInstance)->*Getter)());
+    }
+
+    template<auto Setter>
+    bool writeColumn(QObject* entityInstance, const QVariant& value)
+    {
+        using Traits = ColumnAccessorTraits<decltype(Setter)>;
+        using Class = typename Traits::Class;
+        using Value = typename Traits::Value;
+
+        // NULL values reset the property to its default value
+        if (!value.isValid())
+        {
+            (static_cast<Class*>(entityInstance)->*Setter)(Value{});
+            return true;
+        }
+
+        if (!value.canConvert<Value>())
+            return false;
+
+        (static_cast<Class*>(entityInstance)->*Setter)(value.value<Value>());
+        return true;
+    }
+} // namespace QOrmPrivate
+
+// Declares a column with the READ and WRITE accessors of a property:
+//
+// template<>
+// struct QOrmEntityTraits<Province>
+// {
+//     static constexpr const char* tableName = "provinces";
+//     static constexpr QOrmColumn columns[] = {
+//         qOrmColumn<&Province::id, &Province::setId>("id"),
+//         qOrmColumn<&Province::name, &Province::setName>("name", "province_name")};
+// };
+//
+// The properties must still be declared with Q_PROPERTY(). Properties without a column are
+// accessed through the meta-object system.
+template<auto Getter, auto Setter>
+constexpr QOrmColumn qOrmColumn(const char* propertyName, const char* tableFieldName = nullptr)
+{
+    using GetterTraits = QOrmPrivate::ColumnAccessorTraits<decltype(Getter)>;
+    using SetterTraits = QOrmPrivate::ColumnAccessorTraits<decltype(Setter)>;
+
+    static_assert(std::is_base_of_v<typename SetterTraits::Class, typename GetterTraits::Class> ||
+                      std::is_base_of_v<typename GetterTraits::Class, typename SetterTraits::Class>,
+                  "The accessors of a column must belong to the same entity");
+    static_assert(std::is_same_v<typename GetterTraits::Value, typename SetterTraits::Value>,
+                  "The accessors of a column must have the same value type");
+
+    return QOrmColumn{propertyName,
+                      tableFieldName,
+                      &QOrmPrivate::readColumn<Getter>,
+                      &QOrmPrivate::writeColumn<Setter>};
+}
+
+QT_END_NAMESPACE
+
+#endif // QORMENTITYTRAITS_H
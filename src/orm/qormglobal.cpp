@@ -19,11 +19,61 @@
  */
 
 #include "qormglobal.h"
+#include "qormglobal_p.h"
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qreadwritelock.h>
 
 QT_BEGIN_NAMESPACE
 
+namespace QOrmPrivate
+{
+    struct EntityRegistry
+    {
+        QReadWriteLock lock;
+        QHash<const QMetaObject*, EntityFactory> factories;
+        QHash<const QMetaObject*, EntityTraits> traits;
+    };
+
+    Q_GLOBAL_STATIC(EntityRegistry, entityRegistry)
+
+    void registerEntityFactory(const QMetaObject& qMetaObject, EntityFactory factory)
+    {
+        QWriteLocker locker{&entityRegistry->lock};
+        entityRegistry->factories.insert(&qMetaObject, factory);
+    }
+
+    EntityFactory entityFactory(const QMetaObject& qMetaObject)
+    {
+        QReadLocker locker{&entityRegistry->lock};
+        return entityRegistry->factories.value(&qMetaObject, nullptr);
+    }
+
+    void registerEntityTableName(const QMetaObject& qMetaObject, const char* tableName)
+    {
+        QWriteLocker locker{&entityRegistry->lock};
+        entityRegistry->traits[&qMetaObject].tableName = tableName;
+    }
+
+    void registerEntityColumns(const QMetaObject& qMetaObject,
+                               const QOrmColumn* columns,
+                               int columnCount)
+    {
+        QWriteLocker locker{&entityRegistry->lock};
+
+        EntityTraits& traits = entityRegistry->traits[&qMetaObject];
+        traits.columns = columns;
+        traits.columnCount = columnCount;
+    }
+
+    EntityTraits entityTraits(const QMetaObject& qMetaObject)
+    {
+        QReadLocker locker{&entityRegistry->lock};
+        return entityRegistry->traits.value(&qMetaObject);
+    }
+}
+
 namespace QOrm
 {
     uint qHash(QOrm::Comparison comparison) Q_DECL_NOTHROW
@@ -57,6 +107,10 @@ namespace QOrm
             case Operation::Merge:
                 dbg << "Merge";
                 break;
+
+            case Operation::Count:
+                dbg << "Count";
+                break;
         }
 
         return dbg;
@@ -272,6 +326,26 @@ namespace QOrm
         return dbg;
     }
 
+    QDebug operator<<(QDebug dbg, MergeMode mergeMode)
+    {
+        QDebugStateSaver saver{dbg};
+
+        dbg.noquote().nospace() << "QOrm::MergeMode::";
+
+        switch (mergeMode)
+        {
+            case MergeMode::Auto:
+                dbg << "Auto";
+                break;
+
+            case MergeMode::Upsert:
+                dbg << "Upsert";
+                break;
+        }
+
+        return dbg;
+    }
+
 } // namespace QOrm
 
 QT_END_NAMESPACE
@@ -22,6 +22,8 @@
 #define QORMGLOBAL_H
 
 #include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 #include <QtCore/qglobal.h>
 #include <QtCore/qhashfunctions.h>
@@ -43,6 +45,14 @@ QT_BEGIN_NAMESPACE
 #endif
 
 class QDebug;
+class QOrmColumn;
+
+// Specialize with a static constexpr array of qOrmColumn() named columns, and optionally a static
+// constexpr tableName, to map an entity at compile time. See qormentitytraits.h.
+template<typename T>
+struct QOrmEntityTraits
+{
+};
 
 namespace QOrm
 {
@@ -104,7 +114,8 @@ namespace QOrm
         Read,
         Update,
         Delete,
-        Merge
+        Merge,
+        Count
     };
     extern Q_ORM_EXPORT QDebug operator<<(QDebug dbg, Operation operation);
 
@@ -123,6 +134,13 @@ namespace QOrm
     };
     extern Q_ORM_EXPORT QDebug operator<<(QDebug dbg, FilterExpressionType expressionType);
 
+    enum class MergeMode
+    {
+        Auto,
+        Upsert
+    };
+    extern Q_ORM_EXPORT QDebug operator<<(QDebug dbg, QOrm::MergeMode mergeMode);
+
     enum class RemoveMode
     {
         PreventRemoveAll,
@@ -191,15 +209,73 @@ namespace QOrmPrivate
         }
     }
 
+    using EntityFactory = QObject* (*)();
+
+    template<typename T, typename = void>
+    struct HasEntityColumns : std::false_type
+    {
+    };
+
+    template<typename T>
+    struct HasEntityColumns<T, std::void_t<decltype(QOrmEntityTraits<T>::columns)>>
+        : std::true_type
+    {
+    };
+
+    template<typename T, typename = void>
+    struct HasEntityTableName : std::false_type
+    {
+    };
+
+    template<typename T>
+    struct HasEntityTableName<T, std::void_t<decltype(QOrmEntityTraits<T>::tableName)>>
+        : std::true_type
+    {
+    };
+
+    // Warns if the metadata of the entity has been built before its first registration, which
+    // does not affect metadata that already exists
+    extern Q_ORM_EXPORT void checkEntityRegistration(const QMetaObject& qMetaObject);
+
+    // Entity instances are created with the factory registered for their class, which avoids
+    // the argument marshalling of QMetaObject::newInstance()
+    extern Q_ORM_EXPORT void registerEntityFactory(const QMetaObject& qMetaObject,
+                                                   EntityFactory factory);
+    Q_REQUIRED_RESULT
+    extern Q_ORM_EXPORT EntityFactory entityFactory(const QMetaObject& qMetaObject);
+
+    // The table name and the columns declared in QOrmEntityTraits. They must have static storage
+    // duration.
+    extern Q_ORM_EXPORT void registerEntityTableName(const QMetaObject& qMetaObject,
+                                                     const char* tableName);
+    extern Q_ORM_EXPORT void registerEntityColumns(const QMetaObject& qMetaObject,
+                                                   const QOrmColumn* columns,
+                                                   int columnCount);
+
     template<typename T>
     inline void qRegisterOrmEntity()
     {
+        checkEntityRegistration(T::staticMetaObject);
+
         qRegisterMetaType<T*>();
         qRegisterMetaType<QVector<T*>>();
         qRegisterMetaType<QSet<T*>>();
 
         registerContainerConverter<QVector<T*>>();
         registerContainerConverter<QSet<T*>>();
+
+        if constexpr (std::is_default_constructible_v<T>)
+            registerEntityFactory(T::staticMetaObject, []() -> QObject* { return new T; });
+
+        if constexpr (HasEntityTableName<T>::value)
+            registerEntityTableName(T::staticMetaObject, QOrmEntityTraits<T>::tableName);
+
+        if constexpr (HasEntityColumns<T>::value)
+        {
+            registerEntityColumns(T::staticMetaObject,
+                                  std::data(QOrmEntityTraits<T>::columns),
+                                  static_cast<int>(std::size(QOrmEntityTraits<T>::columns)));
+        }
     }
 } // namespace QtOrmPrivate
 
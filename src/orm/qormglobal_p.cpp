@@ -240,6 +240,180 @@ namespace QOrmPrivate
 
         return std::nullopt;
     }
+
+    static bool isNumeric(const QVariant& value)
+    {
+        switch (value.userType())
+        {
+            case QMetaType::Bool:
+            case QMetaType::Char:
+            case QMetaType::SChar:
+            case QMetaType::UChar:
+            case QMetaType::Short:
+            case QMetaType::UShort:
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::Long:
+            case QMetaType::ULong:
+            case QMetaType::LongLong:
+            case QMetaType::ULongLong:
+            case QMetaType::Float:
+            case QMetaType::Double:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    int compareValues(const QVariant& lhs, const QVariant& rhs)
+    {
+        if (lhs.isNull() || rhs.isNull())
+            return static_cast<int>(!lhs.isNull()) - static_cast<int>(!rhs.isNull());
+
+        bool isLhsNumeric = isNumeric(lhs);
+        bool isRhsNumeric = isNumeric(rhs);
+
+        if (isLhsNumeric && isRhsNumeric)
+        {
+            bool isFloatingPoint = lhs.userType() == QMetaType::Float ||
+                                   lhs.userType() == QMetaType::Double ||
+                                   rhs.userType() == QMetaType::Float ||
+                                   rhs.userType() == QMetaType::Double;
+
+            if (isFloatingPoint)
+            {
+                double l = lhs.toDouble();
+                double r = rhs.toDouble();
+                return l < r ? -1 : (r < l ? 1 : 0);
+            }
+
+            qlonglong l = lhs.toLongLong();
+            qlonglong r = rhs.toLongLong();
+            return l < r ? -1 : (r < l ? 1 : 0);
+        }
+
+        if (isLhsNumeric != isRhsNumeric)
+            return isLhsNumeric ? -1 : 1;
+
+        // dates and times are stored as ISO 8601 text, which sorts chronologically
+        return QString::compare(lhs.toString(), rhs.toString());
+    }
+
+    QVariant storedPropertyValue(const QObject* entityInstance, const QOrmPropertyMapping& mapping)
+    {
+        QVariant value = propertyValue(entityInstance, mapping);
+
+        if (!mapping.isReference() || mapping.isTransient())
+            return value;
+
+        Q_ASSERT(mapping.referencedEntity() != nullptr);
+
+        const QObject* referencedInstance = value.value<QObject*>();
+
+        return referencedInstance == nullptr
+                   ? QVariant{}
+                   : objectIdPropertyValue(referencedInstance, *mapping.referencedEntity());
+    }
+
+    // SQL uses three-valued logic: a comparison with NULL is unknown, and so is its negation
+    static std::optional<bool> evaluate(const QObject* entityInstance,
+                                        const QOrmFilterExpression& expression)
+    {
+        switch (expression.type())
+        {
+            case QOrm::FilterExpressionType::TerminalPredicate:
+            {
+                const QOrmFilterTerminalPredicate* predicate = expression.terminalPredicate();
+                Q_ASSERT(predicate->isResolved());
+
+                const QOrmPropertyMapping& mapping = *predicate->propertyMapping();
+                QVariant value = predicate->value();
+
+                if (mapping.isReference())
+                {
+                    Q_ASSERT(mapping.referencedEntity() != nullptr);
+
+                    const QObject* referencedInstance = value.value<QObject*>();
+                    value = referencedInstance == nullptr
+                                ? QVariant{}
+                                : objectIdPropertyValue(referencedInstance,
+                                                        *mapping.referencedEntity());
+                }
+
+                QVariant instanceValue = storedPropertyValue(entityInstance, mapping);
+
+                if (value.isNull() || instanceValue.isNull())
+                    return std::nullopt;
+
+                int result = compareValues(instanceValue, value);
+
+                switch (predicate->comparison())
+                {
+                    case QOrm::Comparison::Equal:
+                        return result == 0;
+                    case QOrm::Comparison::NotEqual:
+                        return result != 0;
+                    case QOrm::Comparison::Less:
+                        return result < 0;
+                    case QOrm::Comparison::LessOrEqual:
+                        return result <= 0;
+                    case QOrm::Comparison::Greater:
+                        return result > 0;
+                    case QOrm::Comparison::GreaterOrEqual:
+                        return result >= 0;
+                }
+
+                break;
+            }
+
+            case QOrm::FilterExpressionType::BinaryPredicate:
+            {
+                const QOrmFilterBinaryPredicate* predicate = expression.binaryPredicate();
+                std::optional<bool> lhs = evaluate(entityInstance, predicate->lhs());
+                std::optional<bool> rhs = evaluate(entityInstance, predicate->rhs());
+
+                switch (predicate->logicalOperator())
+                {
+                    case QOrm::BinaryLogicalOperator::And:
+                        if (lhs == false || rhs == false)
+                            return false;
+                        break;
+
+                    case QOrm::BinaryLogicalOperator::Or:
+                        if (lhs == true || rhs == true)
+                            return true;
+                        break;
+                }
+
+                if (!lhs.has_value() || !rhs.has_value())
+                    return std::nullopt;
+
+                return *lhs;
+            }
+
+            case QOrm::FilterExpressionType::UnaryPredicate:
+            {
+                const QOrmFilterUnaryPredicate* predicate = expression.unaryPredicate();
+                Q_ASSERT(predicate->logicalOperator() == QOrm::UnaryLogicalOperator::Not);
+
+                std::optional<bool> rhs = evaluate(entityInstance, predicate->rhs());
+
+                if (!rhs.has_value())
+                    return std::nullopt;
+
+                return !*rhs;
+            }
+        }
+
+        Q_ORM_UNEXPECTED_STATE;
+    }
+
+    bool matchesFilterExpression(const QObject* entityInstance,
+                                 const QOrmFilterExpression& expression)
+    {
+        return evaluate(entityInstance, expression).value_or(false);
+    }
 } // namespace QOrmPrivate
 
 #ifdef QT_NO_DEBUG
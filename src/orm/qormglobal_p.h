@@ -56,29 +56,38 @@ namespace std
 
 namespace QOrmPrivate
 {
-    Q_REQUIRED_RESULT
-    inline QVariant propertyValue(const QObject* object, QString property)
+    // registered by qRegisterOrmEntity() from the specialization of QOrmEntityTraits
+    struct EntityTraits
     {
-        return object->property(property.toUtf8().data());
-    }
+        const char* tableName{nullptr};
+        const QOrmColumn* columns{nullptr};
+        int columnCount{0};
+    };
 
+    Q_REQUIRED_RESULT
+    EntityTraits entityTraits(const QMetaObject& qMetaObject);
+
+    // Mapped properties are accessed through the column declared in QOrmEntityTraits if any, and
+    // otherwise through the QMetaProperty of the mapping, without looking up the property name.
     Q_REQUIRED_RESULT
     inline QVariant propertyValue(const QObject* object, const QOrmPropertyMapping& mapping)
     {
-        return propertyValue(object, mapping.classPropertyName());
+        return mapping.read(object);
     }
 
     Q_REQUIRED_RESULT
-    inline bool setPropertyValue(QObject* object, const QString& property, const QVariant& value)
+    inline bool setPropertyValue(QObject* object,
+                                 const QOrmPropertyMapping& mapping,
+                                 const QVariant& value)
     {
-        return object->setProperty(property.toUtf8().data(), value);
+        return mapping.write(object, value);
     }
 
     Q_REQUIRED_RESULT
     inline QVariant objectIdPropertyValue(const QObject* entityInstance, const QOrmMetadata& meta)
     {
         Q_ASSERT(meta.objectIdMapping() != nullptr);
-        return propertyValue(entityInstance, meta.objectIdMapping()->classPropertyName());
+        return propertyValue(entityInstance, *meta.objectIdMapping());
     }
 
     Q_REQUIRED_RESULT
@@ -120,6 +129,24 @@ namespace QOrmPrivate
     extern std::optional<QString> crossReferenceError(const QOrmMetadata& entity,
                                                       const QObject* entityInstance);
 
+    // Compares values like SQLite orders them: NULL first, then numbers, then text
+    Q_REQUIRED_RESULT
+    Q_ORM_EXPORT
+    extern int compareValues(const QVariant& lhs, const QVariant& rhs);
+
+    // Value of a property as stored in the database, a reference is stored as the object ID of
+    // the referenced instance
+    Q_REQUIRED_RESULT
+    Q_ORM_EXPORT
+    extern QVariant storedPropertyValue(const QObject* entityInstance,
+                                        const QOrmPropertyMapping& mapping);
+
+    // Evaluates a resolved filter expression in memory like SQLite evaluates the WHERE clause
+    Q_REQUIRED_RESULT
+    Q_ORM_EXPORT
+    extern bool matchesFilterExpression(const QObject* entityInstance,
+                                        const QOrmFilterExpression& expression);
+
     template<typename E>
     class Unexpected
     {
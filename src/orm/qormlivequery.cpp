@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "qormlivequery.h"
+#include "qormentityinstancecache.h"
+#include "qormerror.h"
+#include "qormfilter.h"
+#include "qormglobal_p.h"
+#include "qormmetadata.h"
+#include "qormorder.h"
+#include "qormquery.h"
+#include "qormrelation.h"
+#include "qormsession.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+class QOrmLiveQueryPrivate
+{
+    friend class QOrmLiveQuery;
+
+    QOrmLiveQueryPrivate(QOrmSession& session, const QOrmQuery& query)
+        : m_session{session}
+        , m_query{query}
+    {
+    }
+
+    bool isIncremental() const { return !m_query.limit().has_value() && m_query.offset() == 0; }
+    bool matches(const QObject* instance) const;
+    bool lessThan(const QObject* lhs, const QObject* rhs) const;
+    int insertionIndex(QObject* instance) const;
+    void setInstances(QVector<QObject*> instances);
+
+    QOrmSession& m_session;
+    QOrmQuery m_query;
+    QOrmError m_error{QOrm::ErrorType::None, {}};
+    // instances of the result are pinned in the session cache
+    QVector<QObject*> m_instances;
+    int m_listenerId{-1};
+    bool m_isRefreshPending{false};
+};
+
+bool QOrmLiveQueryPrivate::matches(const QObject* instance) const
+{
+    if (!m_query.filter().has_value())
+        return true;
+
+    Q_ASSERT(m_query.filter()->type() == QOrm::FilterType::Expression);
+
+    return QOrmPrivate::matchesFilterExpression(instance, *m_query.filter()->expression());
+}
+
+bool QOrmLiveQueryPrivate::lessThan(const QObject* lhs, const QObject* rhs) const
+{
+    for (const QOrmOrder& order : m_query.order())
+    {
+        int result =
+            QOrmPrivate::compareValues(QOrmPrivate::storedPropertyValue(lhs, order.mapping()),
+                                       QOrmPrivate::storedPropertyValue(rhs, order.mapping()));
+
+        if (result != 0)
+            return order.direction() == Qt::AscendingOrder ? result < 0 : result > 0;
+    }
+
+    return false;
+}
+
+int QOrmLiveQueryPrivate::insertionIndex(QObject* instance) const
+{
+    // without an order, the database returns new rows last
+    auto it = std::upper_bound(std::begin(m_instances),
+                               std::end(m_instances),
+                               instance,
+                               [this](const QObject* lhs, const QObject* rhs) {
+                                   return lessThan(lhs, rhs);
+                               });
+
+    return static_cast<int>(std::distance(std::begin(m_instances), it));
+}
+
+void QOrmLiveQueryPrivate::setInstances(QVector<QObject*> instances)
+{
+    QOrmEntityInstanceCache* cache = m_session.entityInstanceCache();
+
+    for (const QObject* instance : instances)
+        cache->pin(instance);
+
+    for (const QObject* instance : m_instances)
+        cache->unpin(instance);
+
+    m_instances = std::move(instances);
+}
+
+QOrmLiveQuery::QOrmLiveQuery(QOrmSession& session, const QOrmQuery& query, QObject* parent)
+    : QObject{parent}
+    , d{new QOrmLiveQueryPrivate{session, query}}
+{
+    Q_ASSERT(query.operation() == QOrm::Operation::Read);
+    Q_ASSERT(query.relation().type() == QOrm::RelationType::Mapping);
+    Q_ASSERT(!query.projection().has_value() ||
+             query.projection()->className() == query.relation().mapping()->className());
+
+    d->m_listenerId = session.addEntityChangeListener(
+        query.relation().mapping()->qMetaObject(),
+        this,
+        [this](QOrm::Operation operation, QObject* instance) {
+            onEntityInstanceChanged(operation, instance);
+        });
+
+    refresh();
+}
+
+QOrmLiveQuery::~QOrmLiveQuery()
+{
+    d->m_session.removeEntityChangeListener(d->m_listenerId);
+    d->setInstances({});
+}
+
+const QOrmQuery& QOrmLiveQuery::query() const
+{
+    return d->m_query;
+}
+
+const QOrmError& QOrmLiveQuery::error() const
+{
+    return d->m_error;
+}
+
+const QVector<QObject*>& QOrmLiveQuery::instances() const
+{
+    return d->m_instances;
+}
+
+QOrmQueryResult<QObject> QOrmLiveQuery::result() const
+{
+    return QOrmQueryResult<QObject>{d->m_error, d->m_instances, {}};
+}
+
+bool QOrmLiveQuery::refresh()
+{
+    d->m_isRefreshPending = false;
+
+    QOrmQueryResult<QObject> result = d->m_session.execute(d->m_query);
+    d->m_error = result.error();
+
+    if (d->m_error.type() == QOrm::ErrorType::None)
+        d->setInstances(result.toVector());
+    else
+        d->setInstances({});
+
+    Q_EMIT refreshed();
+
+    return d->m_error.type() == QOrm::ErrorType::None;
+}
+
+void QOrmLiveQuery::onEntityInstanceChanged(QOrm::Operation operation, QObject* instance)
+{
+    // The rows around a limit or an offset are not known. The query is read again once control
+    // returns to the event loop, the session is in the middle of a write now.
+    if (!d->isIncremental())
+    {
+        if (!d->m_isRefreshPending)
+        {
+            d->m_isRefreshPending = true;
+            QMetaObject::invokeMethod(
+                this,
+                [this]() {
+                    if (d->m_isRefreshPending)
+                        refresh();
+                },
+                Qt::QueuedConnection);
+        }
+
+        return;
+    }
+
+    QOrmEntityInstanceCache* cache = d->m_session.entityInstanceCache();
+    int index = d->m_instances.indexOf(instance);
+
+    if (operation == QOrm::Operation::Delete || !d->matches(instance))
+    {
+        if (index >= 0)
+        {
+            cache->unpin(instance);
+            d->m_instances.remove(index);
+            Q_EMIT instanceRemoved(index);
+        }
+
+        return;
+    }
+
+    if (index < 0)
+    {
+        index = d->insertionIndex(instance);
+        cache->pin(instance);
+        d->m_instances.insert(index, instance);
+        Q_EMIT instanceInserted(index);
+        return;
+    }
+
+    Q_EMIT instanceUpdated(index);
+
+    if (d->m_query.order().empty())
+        return;
+
+    d->m_instances.remove(index);
+    int newIndex = d->insertionIndex(instance);
+    d->m_instances.insert(newIndex, instance);
+
+    if (newIndex != index)
+        Q_EMIT instanceMoved(index, newIndex);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef QORMLIVEQUERY_H
+#define QORMLIVEQUERY_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvector.h>
+
+#include <QtOrm/qormglobal.h>
+#include <QtOrm/qormqueryresult.h>
+
+QT_BEGIN_NAMESPACE
+
+class QOrmError;
+class QOrmLiveQueryPrivate;
+class QOrmQuery;
+class QOrmSession;
+
+// The result of a read query that follows the changes made through the session. Written and
+// removed instances of the entity are evaluated against the filter and the order of the query in
+// memory, so the query is not executed again. Queries with a limit or an offset are read again
+// after a change instead.
+class Q_ORM_EXPORT QOrmLiveQuery : public QObject
+{
+    Q_OBJECT
+
+public:
+    QOrmLiveQuery(QOrmSession& session, const QOrmQuery& query, QObject* parent = nullptr);
+    ~QOrmLiveQuery() override;
+
+    Q_REQUIRED_RESULT
+    const QOrmQuery& query() const;
+
+    Q_REQUIRED_RESULT
+    const QOrmError& error() const;
+
+    Q_REQUIRED_RESULT
+    const QVector<QObject*>& instances() const;
+
+    Q_REQUIRED_RESULT
+    QOrmQueryResult<QObject> result() const;
+
+    bool refresh();
+
+Q_SIGNALS:
+    void instanceInserted(int index);
+    void instanceUpdated(int index);
+    void instanceMoved(int from, int to);
+    void instanceRemoved(int index);
+    void refreshed();
+
+private:
+    void onEntityInstanceChanged(QOrm::Operation operation, QObject* instance);
+
+    QScopedPointer<QOrmLiveQueryPrivate> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QORMLIVEQUERY_H
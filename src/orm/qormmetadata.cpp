@@ -57,6 +57,11 @@ QString QOrmMetadata::tableName() const
     return d->m_tableName;
 }
 
+QObject* QOrmMetadata::newInstance() const
+{
+    return d->m_entityFactory != nullptr ? d->m_entityFactory() : d->m_qMetaObject.newInstance();
+}
+
 const std::vector<QOrmPropertyMapping>& QOrmMetadata::propertyMappings() const
 {
     return d->m_propertyMappings;
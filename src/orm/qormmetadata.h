@@ -52,6 +52,10 @@ public:
     Q_REQUIRED_RESULT QString className() const;
     Q_REQUIRED_RESULT QString tableName() const;
 
+    // Creates an instance of the entity with the factory registered by qRegisterOrmEntity(), or
+    // with QMetaObject::newInstance() if there is none
+    Q_REQUIRED_RESULT QObject* newInstance() const;
+
     Q_REQUIRED_RESULT
     const std::vector<QOrmPropertyMapping>& propertyMappings() const;
     Q_REQUIRED_RESULT
@@ -40,6 +40,8 @@ public:
     QString m_className;
     QString m_tableName;
     std::vector<QOrmPropertyMapping> m_propertyMappings;
+    // registered by qRegisterOrmEntity(), null if the entity has not been registered
+    QOrmPrivate::EntityFactory m_entityFactory{nullptr};
 
     int m_objectIdPropertyMappingIdx{-1};
     QHash<QString, int> m_classPropertyMappingIndex;
@@ -19,6 +19,7 @@
  */
 
 #include "qormmetadatacache.h"
+#include "qormentitytraits.h"
 #include "qormglobal_p.h"
 #include "qormmetadata_p.h"
 #include "qormpropertymapping.h"
@@ -26,12 +27,20 @@
 #include <QHash>
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QReadWriteLock>
 #include <QSet>
 #include <QVector>
 
+#include <algorithm>
+
+// Metadata is immutable once it has been built, so one registry serves all sessions and threads.
+// Entries are never removed, and references to them stay valid.
 class QOrmMetadataCachePrivate
 {
     friend class QOrmMetadataCache;
+    friend void QOrmPrivate::checkEntityRegistration(const QMetaObject& qMetaObject);
+
+    static QOrmMetadataCachePrivate* instance();
 
     struct MappingDescriptor
     {
@@ -43,12 +52,17 @@ class QOrmMetadataCachePrivate
         bool isTransient = false;
     };
 
+    QReadWriteLock m_lock;
     std::unordered_map<QByteArray, QOrmMetadata> m_cache;
 
     QSet<QByteArray> m_underConstruction;
     QSet<QByteArray> m_constructed;
+    // entities that have been registered with qRegisterOrmEntity()
+    QSet<const QMetaObject*> m_registered;
 
     const QOrmMetadata& get(const QMetaObject& metaObject);
+    // must be called with the write lock held
+    const QOrmMetadata& getOrInitialize(const QMetaObject& metaObject);
 
     void initialize(const QByteArray& className, const QMetaObject& qMetaObject);
 
@@ -61,10 +75,57 @@ class QOrmMetadataCachePrivate
     void validateCrossReferences(Container&& entityNames);
 };
 
+Q_GLOBAL_STATIC(QOrmMetadataCachePrivate, metadataCacheInstance)
+
+QOrmMetadataCachePrivate* QOrmMetadataCachePrivate::instance()
+{
+    return metadataCacheInstance;
+}
+
+void QOrmPrivate::checkEntityRegistration(const QMetaObject& qMetaObject)
+{
+    QOrmMetadataCachePrivate* d = QOrmMetadataCachePrivate::instance();
+    QWriteLocker locker{&d->m_lock};
+
+    if (d->m_registered.contains(&qMetaObject))
+        return;
+
+    d->m_registered.insert(&qMetaObject);
+
+    // the metadata has been built with the default factory, table name and columns
+    if (d->m_cache.find(QByteArray{qMetaObject.className()}) != std::end(d->m_cache))
+    {
+        qCWarning(qtorm,
+                  "QtOrm: qRegisterOrmEntity<%s>() is called after the metadata of %s has been "
+                  "built and has no effect on it. Register entities before they are used.",
+                  qMetaObject.className(),
+                  qMetaObject.className());
+    }
+}
+
 const QOrmMetadata& QOrmMetadataCachePrivate::get(const QMetaObject& qMetaObject)
 {
     QByteArray className{qMetaObject.className()};
 
+    {
+        QReadLocker locker{&m_lock};
+
+        auto it = m_cache.find(className);
+
+        // entities being initialized by the writer are not visible to readers
+        if (it != std::end(m_cache))
+            return it->second;
+    }
+
+    QWriteLocker locker{&m_lock};
+
+    return getOrInitialize(qMetaObject);
+}
+
+const QOrmMetadata& QOrmMetadataCachePrivate::getOrInitialize(const QMetaObject& qMetaObject)
+{
+    QByteArray className{qMetaObject.className()};
+
     if (m_cache.find(className) == std::end(m_cache))
     {
         initialize(className, qMetaObject);
@@ -90,6 +151,23 @@ void QOrmMetadataCachePrivate::initialize(const QByteArray& className,
     // initialize the private part of the cached object
     data->m_className = QString::fromUtf8(className);
     data->m_tableName = data->m_className;
+    data->m_entityFactory = QOrmPrivate::entityFactory(qMetaObject);
+
+    QOrmPrivate::EntityTraits traits = QOrmPrivate::entityTraits(qMetaObject);
+
+    if (traits.tableName != nullptr)
+        data->m_tableName = QString::fromUtf8(traits.tableName);
+
+    for (int i = 0; i < traits.columnCount; ++i)
+    {
+        if (qMetaObject.indexOfProperty(traits.columns[i].propertyName) < 0)
+        {
+            qFatal("QtOrm: The column %s declared in QOrmEntityTraits<%s> is not a property of %s",
+                   traits.columns[i].propertyName,
+                   className.data(),
+                   className.data());
+        }
+    }
 
     for (int i = 0; i < qMetaObject.propertyCount(); ++i)
     {
@@ -110,6 +188,18 @@ void QOrmMetadataCachePrivate::initialize(const QByteArray& className,
 
         MappingDescriptor descriptor = mappingDescriptor(qMetaObject, property);
 
+        const QOrmColumn* column =
+            std::find_if(traits.columns,
+                         traits.columns + traits.columnCount,
+                         [&property](const QOrmColumn& column) {
+                             return qstrcmp(column.propertyName, property.name()) == 0;
+                         });
+
+        if (column == traits.columns + traits.columnCount)
+            column = nullptr;
+        else if (column->tableFieldName != nullptr && !descriptor.isTransient)
+            descriptor.tableFieldName = QString::fromUtf8(column->tableFieldName);
+
         data->m_propertyMappings.emplace_back(m_cache.at(className),
                                               property,
                                               descriptor.classPropertyName,
@@ -118,7 +208,8 @@ void QOrmMetadataCachePrivate::initialize(const QByteArray& className,
                                               descriptor.isAutogenerated,
                                               property.type(),
                                               descriptor.referencedEntity,
-                                              descriptor.isTransient);
+                                              descriptor.isTransient,
+                                              column);
         auto idx = static_cast<int>(data->m_propertyMappings.size() - 1);
 
         data->m_classPropertyMappingIndex.insert(descriptor.classPropertyName, idx);
@@ -202,7 +293,7 @@ QOrmMetadataCachePrivate::MappingDescriptor QOrmMetadataCachePrivate::mappingDes
                    property.name());
         }
 
-        descriptor.referencedEntity = &get(*referencedMeta);
+        descriptor.referencedEntity = &getOrInitialize(*referencedMeta);
         Q_ASSERT(descriptor.referencedEntity != nullptr);
     }
 
@@ -290,8 +381,8 @@ void QOrmMetadataCachePrivate::validateCrossReferences(Container&& entityNames)
 }
 
 QOrmMetadataCache::QOrmMetadataCache()
-    : d{new QOrmMetadataCachePrivate}
-{    
+    : d{QOrmMetadataCachePrivate::instance()}
+{
 }
 
 QOrmMetadataCache::QOrmMetadataCache(QOrmMetadataCache&&) = default;
@@ -304,3 +395,11 @@ const QOrmMetadata& QOrmMetadataCache::operator[](const QMetaObject& qMetaObject
 {
     return d->get(qMetaObject);
 }
+
+void QOrmMetadataCache::preload(std::initializer_list<const QMetaObject*> qMetaObjects)
+{
+    QOrmMetadataCachePrivate* cache = QOrmMetadataCachePrivate::instance();
+
+    for (const QMetaObject* qMetaObject : qMetaObjects)
+        cache->get(*qMetaObject);
+}
@@ -24,7 +24,7 @@
 #include <QtOrm/qormglobal.h>
 #include <QtOrm/qormmetadata.h>
 
-#include <memory>
+#include <initializer_list>
 
 QT_BEGIN_NAMESPACE
 
@@ -32,12 +32,14 @@ class QOrmMetadata;
 class QOrmMetadataCachePrivate;
 class QMetaObject;
 
+// The metadata of an entity is built once per process. All QOrmMetadataCache objects share it, and
+// it can be read from any thread.
 class Q_ORM_EXPORT QOrmMetadataCache
 {
     Q_DISABLE_COPY(QOrmMetadataCache)
 
 public:
-    QOrmMetadataCache();    
+    QOrmMetadataCache();
     QOrmMetadataCache(QOrmMetadataCache&&);
     ~QOrmMetadataCache();
 
@@ -56,8 +58,18 @@ public:
     Q_REQUIRED_RESULT
     const QOrmMetadata& get(const QMetaObject& qMetaObject) { return operator[](qMetaObject); }
 
+    // Builds the metadata of the entities in advance, e.g. at startup after the entities have
+    // been registered with qRegisterOrmEntity()
+    template<typename... Ts>
+    static void preload()
+    {
+        preload({&Ts::staticMetaObject...});
+    }
+
+    static void preload(std::initializer_list<const QMetaObject*> qMetaObjects);
+
 private:
-    std::unique_ptr<QOrmMetadataCachePrivate> d;
+    QOrmMetadataCachePrivate* d{nullptr};
 };
 
 QT_END_NAMESPACE
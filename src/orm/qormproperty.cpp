@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "qormproperty.h"
+#include "qormmetadatacache.h"
+
+QT_BEGIN_NAMESPACE
+
+namespace QOrmPrivate
+{
+    const QOrmPropertyMapping& classPropertyMapping(const QMetaObject& qMetaObject,
+                                                    const char* classPropertyName,
+                                                    int valueTypeId,
+                                                    QVariant (*read)(const QObject* entityInstance))
+    {
+        // metadata is never removed from the registry, so the mapping outlives all queries
+        QOrmMetadataCache cache;
+        const QOrmPropertyMapping* mapping =
+            cache.get(qMetaObject).classPropertyMapping(QString::fromUtf8(classPropertyName));
+
+        if (mapping == nullptr)
+        {
+            qFatal("QtOrm: %s is not a mapped property of %s",
+                   classPropertyName,
+                   qMetaObject.className());
+        }
+
+        // Qt does not expose the READ accessor of a property, so a property accessed through the
+        // meta-object system is checked by its type only
+        bool isMatching = mapping->column() != nullptr
+                              ? mapping->column()->read == read
+                              : mapping->qMetaProperty().userType() == valueTypeId;
+
+        if (!isMatching)
+        {
+            qFatal("QtOrm: %s::%s is not the property read by the accessor it is declared with",
+                   qMetaObject.className(),
+                   classPropertyName);
+        }
+
+        return *mapping;
+    }
+} // namespace QOrmPrivate
+
+QT_END_NAMESPACE
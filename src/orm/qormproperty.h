@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef QORMPROPERTY_H
+#define QORMPROPERTY_H
+
+#include <QtOrm/qormentitytraits.h>
+#include <QtOrm/qormfilterexpression.h>
+#include <QtOrm/qormglobal.h>
+#include <QtOrm/qormpropertymapping.h>
+
+#include <QtCore/qvariant.h>
+
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+namespace QOrmPrivate
+{
+    // Looks up the mapping in the process-wide metadata registry and verifies it against the READ
+    // accessor of the property: a column declared in QOrmEntityTraits must be read by the
+    // accessor, otherwise the property must have the value type of the accessor. Terminates if
+    // the entity has no such property or the property does not match the accessor.
+    Q_REQUIRED_RESULT
+    extern Q_ORM_EXPORT const QOrmPropertyMapping& classPropertyMapping(
+        const QMetaObject& qMetaObject,
+        const char* classPropertyName,
+        int valueTypeId,
+        QVariant (*read)(const QObject* entityInstance));
+} // namespace QOrmPrivate
+
+// A property of an entity identified by its READ accessor. Unlike QOrmClassProperty, the entity
+// and the value type are checked at compile time, and the property mapping is looked up and
+// verified against the accessor once per process instead of on every query. Q_ORM_PROPERTY()
+// names the property after its accessor. Otherwise, declare constants:
+//
+// namespace Community_
+// {
+//     constexpr QOrmProperty<&Community::province> province{"province"};
+// }
+template<auto Getter, typename Entity = typename QOrmPrivate::ColumnAccessorTraits<
+                          decltype(Getter)>::Class>
+class QOrmProperty
+{
+public:
+    using EntityType = Entity;
+    using ValueType = typename QOrmPrivate::ColumnAccessorTraits<decltype(Getter)>::Value;
+
+    static_assert(std::is_base_of_v<typename QOrmPrivate::ColumnAccessorTraits<
+                                        decltype(Getter)>::Class,
+                                    Entity>,
+                  "The accessor of a property must belong to the entity");
+
+    constexpr explicit QOrmProperty(const char* classPropertyName)
+        : m_classPropertyName{classPropertyName}
+    {
+    }
+
+    Q_REQUIRED_RESULT
+    constexpr const char* classPropertyName() const { return m_classPropertyName; }
+
+    Q_REQUIRED_RESULT
+    const QOrmPropertyMapping& mapping() const
+    {
+        static const char* classPropertyName = m_classPropertyName;
+        static const QOrmPropertyMapping& mapping =
+            QOrmPrivate::classPropertyMapping(Entity::staticMetaObject,
+                                              m_classPropertyName,
+                                              qMetaTypeId<ValueType>(),
+                                              &QOrmPrivate::readColumn<Getter>);
+
+        // an accessor reads a single property
+        if (m_classPropertyName != classPropertyName &&
+            qstrcmp(m_classPropertyName, classPropertyName) != 0)
+        {
+            qFatal("QtOrm: the accessor of %s::%s is also declared as the accessor of %s",
+                   Entity::staticMetaObject.className(),
+                   classPropertyName,
+                   m_classPropertyName);
+        }
+
+        return mapping;
+    }
+
+    template<typename T>
+    Q_REQUIRED_RESULT QOrmFilterTerminalPredicate predicate(QOrm::Comparison comparison,
+                                                            T&& value) const
+    {
+        if constexpr (std::is_same_v<std::decay_t<T>, QVariant>)
+        {
+            return {mapping(), comparison, std::forward<T>(value)};
+        }
+        else
+        {
+            static_assert(std::is_convertible_v<T, ValueType>,
+                          "The value is not convertible to the type of the property");
+
+            return {mapping(),
+                    comparison,
+                    QVariant::fromValue(static_cast<ValueType>(std::forward<T>(value)))};
+        }
+    }
+
+private:
+    const char* m_classPropertyName;
+};
+
+#define Q_ORM_PROPERTY(entity, property) (QOrmProperty<&entity::property, entity>{#property})
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator==(QOrmProperty<Getter, Entity> property,
+                                                            T&& value)
+{
+    return property.predicate(QOrm::Comparison::Equal, std::forward<T>(value));
+}
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator!=(QOrmProperty<Getter, Entity> property,
+                                                            T&& value)
+{
+    return property.predicate(QOrm::Comparison::NotEqual, std::forward<T>(value));
+}
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator<(QOrmProperty<Getter, Entity> property,
+                                                           T&& value)
+{
+    return property.predicate(QOrm::Comparison::Less, std::forward<T>(value));
+}
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator<=(QOrmProperty<Getter, Entity> property,
+                                                            T&& value)
+{
+    return property.predicate(QOrm::Comparison::LessOrEqual, std::forward<T>(value));
+}
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator>(QOrmProperty<Getter, Entity> property,
+                                                           T&& value)
+{
+    return property.predicate(QOrm::Comparison::Greater, std::forward<T>(value));
+}
+
+template<auto Getter, typename Entity, typename T>
+[[nodiscard]] inline QOrmFilterTerminalPredicate operator>=(QOrmProperty<Getter, Entity> property,
+                                                            T&& value)
+{
+    return property.predicate(QOrm::Comparison::GreaterOrEqual, std::forward<T>(value));
+}
+
+QT_END_NAMESPACE
+
+#endif // QORMPROPERTY_H
@@ -19,6 +19,7 @@
  */
 
 #include "qormpropertymapping.h"
+#include "qormentitytraits.h"
 
 #include <QDebug>
 
@@ -57,7 +58,8 @@ class QOrmPropertyMappingPrivate : public QSharedData
                                bool isAutoGenerated,
                                QVariant::Type dataType,
                                const QOrmMetadata* referencedEntity,
-                               bool isTransient)
+                               bool isTransient,
+                               const QOrmColumn* column)
         : m_enclosingEntity{enclosingEntity}
         , m_qMetaProperty{std::move(qMetaProperty)}
         , m_classPropertyName{std::move(classPropertyName)}
@@ -67,6 +69,7 @@ class QOrmPropertyMappingPrivate : public QSharedData
         , m_dataType{dataType}
         , m_referencedEntity{referencedEntity}
         , m_isTransient{isTransient}
+        , m_column{column}
     {
     }
 
@@ -79,6 +82,7 @@ class QOrmPropertyMappingPrivate : public QSharedData
     QVariant::Type m_dataType{QVariant::Invalid};
     const QOrmMetadata* m_referencedEntity{nullptr};
     bool m_isTransient{false};
+    const QOrmColumn* m_column{nullptr};
 };
 
 QOrmPropertyMapping::QOrmPropertyMapping(const QOrmMetadata& enclosingEntity,
@@ -89,7 +93,8 @@ QOrmPropertyMapping::QOrmPropertyMapping(const QOrmMetadata& enclosingEntity,
                                          bool isAutoGenerated,
                                          QVariant::Type dataType,
                                          const QOrmMetadata* referencedEntity,
-                                         bool isTransient)
+                                         bool isTransient,
+                                         const QOrmColumn* column)
     : d{new QOrmPropertyMappingPrivate{enclosingEntity,
                                        std::move(qMetaProperty),
                                        std::move(classPropertyName),
@@ -98,7 +103,8 @@ QOrmPropertyMapping::QOrmPropertyMapping(const QOrmMetadata& enclosingEntity,
                                        isAutoGenerated,
                                        dataType,
                                        referencedEntity,
-                                       isTransient}}
+                                       isTransient,
+                                       column}}
 {
 }
 
@@ -167,4 +173,25 @@ bool QOrmPropertyMapping::isTransient() const
     return d->m_isTransient;
 }
 
+const QOrmColumn* QOrmPropertyMapping::column() const
+{
+    return d->m_column;
+}
+
+QVariant QOrmPropertyMapping::read(const QObject* entityInstance) const
+{
+    if (d->m_column != nullptr)
+        return d->m_column->read(entityInstance);
+
+    return d->m_qMetaProperty.read(entityInstance);
+}
+
+bool QOrmPropertyMapping::write(QObject* entityInstance, const QVariant& value) const
+{
+    if (d->m_column != nullptr)
+        return d->m_column->write(entityInstance, value);
+
+    return d->m_qMetaProperty.write(entityInstance, value);
+}
+
 QT_END_NAMESPACE
@@ -44,7 +44,8 @@ public:
                         bool isAutoGenerated,
                         QVariant::Type dataType,
                         const QOrmMetadata* referencedEntity,
-                        bool isTransient);
+                        bool isTransient,
+                        const QOrmColumn* column = nullptr);
     QOrmPropertyMapping(const QOrmPropertyMapping&);
     QOrmPropertyMapping(QOrmPropertyMapping&&);
     ~QOrmPropertyMapping();
@@ -85,6 +86,15 @@ public:
     Q_REQUIRED_RESULT
     bool isTransient() const;
 
+    // The column declared in QOrmEntityTraits, or nullptr if the property is accessed through
+    // the meta-object system
+    Q_REQUIRED_RESULT
+    const QOrmColumn* column() const;
+
+    Q_REQUIRED_RESULT
+    QVariant read(const QObject* entityInstance) const;
+    bool write(QObject* entityInstance, const QVariant& value) const;
+
 private:
     QSharedDataPointer<QOrmPropertyMappingPrivate> d;
 };
@@ -36,13 +36,17 @@ public:
                      const std::optional<QOrmMetadata>& projection,
                      const std::optional<QOrmFilter>& filter,
                      const std::vector<QOrmOrder>& order,
-                     const QFlags<QOrm::QueryFlags>& flags)
+                     const QFlags<QOrm::QueryFlags>& flags,
+                     const std::optional<int>& limit,
+                     int offset)
         : m_operation{operation}
         , m_relation{relation}
         , m_projection{projection}
         , m_filter{filter}
         , m_order{order}
         , m_flags{flags}
+        , m_limit{limit}
+        , m_offset{offset}
     {
     }
 
@@ -62,6 +66,8 @@ public:
     std::vector<QOrmOrder> m_order;
     QObject* m_entityInstance{nullptr};
     QFlags<QOrm::QueryFlags> m_flags;
+    std::optional<int> m_limit;
+    int m_offset{0};
 };
 
 QOrmQuery::QOrmQuery(QOrm::Operation operation,
@@ -69,8 +75,10 @@ QOrmQuery::QOrmQuery(QOrm::Operation operation,
                      const std::optional<QOrmMetadata>& projection,
                      const std::optional<QOrmFilter>& filter,
                      const std::vector<QOrmOrder>& order,
-                     const QFlags<QOrm::QueryFlags>& flags)
-    : d{new QOrmQueryPrivate{operation, relation, projection, filter, order, flags}}
+                     const QFlags<QOrm::QueryFlags>& flags,
+                     const std::optional<int>& limit,
+                     int offset)
+    : d{new QOrmQueryPrivate{operation, relation, projection, filter, order, flags, limit, offset}}
 {
 }
 
@@ -116,6 +124,16 @@ const std::vector<QOrmOrder>& QOrmQuery::order() const
     return d->m_order;
 }
 
+const std::optional<int>& QOrmQuery::limit() const
+{
+    return d->m_limit;
+}
+
+int QOrmQuery::offset() const
+{
+    return d->m_offset;
+}
+
 const QObject* QOrmQuery::entityInstance() const
 {
     return d->m_entityInstance;
@@ -141,6 +159,12 @@ QDebug operator<<(QDebug dbg, const QOrmQuery& query)
     if (!query.order().empty())
         dbg << ", " << query.order();
 
+    if (query.limit().has_value())
+        dbg << ", LIMIT " << *query.limit();
+
+    if (query.offset() > 0)
+        dbg << ", OFFSET " << query.offset();
+
     if (query.entityInstance() != nullptr)
         dbg << ", " << query.entityInstance();
 
@@ -46,7 +46,9 @@ public:
               const std::optional<QOrmMetadata>& projection,
               const std::optional<QOrmFilter>& filter,
               const std::vector<QOrmOrder>& order,
-              const QFlags<QOrm::QueryFlags>& flags);
+              const QFlags<QOrm::QueryFlags>& flags,
+              const std::optional<int>& limit = std::nullopt,
+              int offset = 0);
     QOrmQuery(QOrm::Operation operation, const QOrmMetadata& relation, QObject* entityInstance);
     QOrmQuery(const QOrmQuery&);
     QOrmQuery(QOrmQuery&&);
@@ -70,6 +72,12 @@ public:
     Q_REQUIRED_RESULT
     const std::vector<QOrmOrder>& order() const;
 
+    Q_REQUIRED_RESULT
+    const std::optional<int>& limit() const;
+
+    Q_REQUIRED_RESULT
+    int offset() const;
+
     Q_REQUIRED_RESULT
     const QObject* entityInstance() const;
 
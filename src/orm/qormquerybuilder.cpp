@@ -89,6 +89,8 @@ namespace QOrmPrivate
         QObject* m_entityInstance{nullptr};
         std::vector<QOrmFilter> m_filters;
         std::vector<QOrmOrder> m_order;
+        std::optional<int> m_limit;
+        int m_offset{0};
     };
 
     QueryBuilderHelper::QueryBuilderHelper(QOrmSession* ormSession, const QOrmRelation& relation)
@@ -125,6 +127,26 @@ namespace QOrmPrivate
         d->m_order.emplace_back(*mapping, direction);
     }
 
+    void QueryBuilderHelper::addOrder(const QOrmPropertyMapping& mapping, Qt::SortOrder direction)
+    {
+        Q_ASSERT(d->m_projection.has_value());
+        Q_ASSERT(&mapping.enclosingEntity().qMetaObject() == &d->m_projection->qMetaObject());
+
+        d->m_order.emplace_back(mapping, direction);
+    }
+
+    void QueryBuilderHelper::setLimit(int limit)
+    {
+        Q_ASSERT(limit >= 0);
+        d->m_limit = limit;
+    }
+
+    void QueryBuilderHelper::setOffset(int offset)
+    {
+        Q_ASSERT(offset >= 0);
+        d->m_offset = offset;
+    }
+
     QOrmQuery QueryBuilderHelper::build(QOrm::Operation operation, QOrm::QueryFlags flags) const
     {
         if (operation == QOrm::Operation::Merge || operation == QOrm::Operation::Create ||
@@ -135,7 +157,7 @@ namespace QOrmPrivate
 
             return QOrmQuery{operation, *d->m_relation.mapping(), d->m_entityInstance};
         }
-        else if (operation == QOrm::Operation::Read ||
+        else if (operation == QOrm::Operation::Read || operation == QOrm::Operation::Count ||
                  (operation == QOrm::Operation::Delete &&
                   d->m_relation.type() == QOrm::RelationType::Query))
         {
@@ -144,7 +166,9 @@ namespace QOrmPrivate
                              d->m_projection,
                              foldFilters(d->m_relation, d->m_filters),
                              d->m_order,
-                             flags};
+                             flags,
+                             d->m_limit,
+                             d->m_offset};
         }
 
         qFatal("Unexpected state");
@@ -154,6 +178,61 @@ namespace QOrmPrivate
     {
         return d->m_session->execute(build(QOrm::Operation::Read, flags));
     }
+
+    int QueryBuilderHelper::count() const
+    {
+        QOrmQueryResult<QObject> result =
+            d->m_session->execute(build(QOrm::Operation::Count, QOrm::QueryFlags::None));
+
+        // the provider returns the number of instances the same way as the number of removed rows
+        return result.error().type() == QOrm::ErrorType::None ? result.lastInsertedId().toInt()
+                                                              : -1;
+    }
+
+    bool QueryBuilderHelper::projectionInherits(const QMetaObject& qMetaObject) const
+    {
+        Q_ASSERT(d->m_projection.has_value());
+
+        return d->m_projection->qMetaObject().inherits(&qMetaObject);
+    }
+
+    int QueryBuilderHelper::propertyMappingIndex(const char* classPropertyName) const
+    {
+        Q_ASSERT(d->m_projection.has_value());
+
+        const QOrmPropertyMapping* mapping =
+            d->m_projection->classPropertyMapping(QString::fromUtf8(classPropertyName));
+
+        if (mapping == nullptr)
+        {
+            qFatal("QtOrm: %s is not a mapped property of %s",
+                   classPropertyName,
+                   qPrintable(d->m_projection->className()));
+        }
+
+        return static_cast<int>(mapping - d->m_projection->propertyMappings().data());
+    }
+
+    std::vector<std::pair<QMetaProperty, int>> QueryBuilderHelper::gadgetColumns(
+        const QMetaObject& gadgetMetaObject) const
+    {
+        std::vector<std::pair<QMetaProperty, int>> columns;
+
+        for (int i = gadgetMetaObject.propertyOffset(); i < gadgetMetaObject.propertyCount(); ++i)
+        {
+            QMetaProperty property = gadgetMetaObject.property(i);
+            columns.emplace_back(property, propertyMappingIndex(property.name()));
+        }
+
+        return columns;
+    }
+
+    QOrmError QueryBuilderHelper::readValues(
+        const std::function<void(const QVector<QVariant>&)>& handler) const
+    {
+        return d->m_session->readValues(build(QOrm::Operation::Read, QOrm::QueryFlags::None),
+                                        handler);
+    }
 } // namespace QOrmPrivate
 
 QT_END_NAMESPACE
@@ -21,17 +21,23 @@
 #ifndef QORMQUERYBUILDER_H
 #define QORMQUERYBUILDER_H
 
+#include <QtOrm/qormcolumnbatch.h>
 #include <QtOrm/qormfilter.h>
 #include <QtOrm/qormfilterexpression.h>
 #include <QtOrm/qormglobal.h>
+#include <QtOrm/qormproperty.h>
 #include <QtOrm/qormquery.h>
 #include <QtOrm/qormqueryresult.h>
 
+#include <QtCore/qmetaobject.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qshareddata.h>
 #include <QtCore/qvector.h>
 
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -60,6 +66,9 @@ namespace QOrmPrivate
         void setInstance(const QMetaObject& qMetaObject, QObject* instance);
         void addFilter(const QOrmFilter& filter);
         void addOrder(const QOrmClassProperty& classProperty, Qt::SortOrder direction);
+        void addOrder(const QOrmPropertyMapping& mapping, Qt::SortOrder direction);
+        void setLimit(int limit);
+        void setOffset(int offset);
 
         Q_REQUIRED_RESULT
         QOrmQuery build(QOrm::Operation operation, QOrm::QueryFlags flags) const;
@@ -67,6 +76,24 @@ namespace QOrmPrivate
         Q_REQUIRED_RESULT
         QOrmQueryResult<QObject> select(QOrm::QueryFlags flags) const;
 
+        Q_REQUIRED_RESULT
+        int count() const;
+
+        Q_REQUIRED_RESULT
+        bool projectionInherits(const QMetaObject& qMetaObject) const;
+
+        // The index of the property mapping of the projection with the given name
+        Q_REQUIRED_RESULT
+        int propertyMappingIndex(const char* classPropertyName) const;
+
+        // Maps the properties of a gadget to the indices of the property mappings of the
+        // projection with the same names
+        Q_REQUIRED_RESULT
+        std::vector<std::pair<QMetaProperty, int>> gadgetColumns(
+            const QMetaObject& gadgetMetaObject) const;
+
+        QOrmError readValues(const std::function<void(const QVector<QVariant>&)>& handler) const;
+
     private:
         std::unique_ptr<QueryBuilderHelperPrivate> d;
     };
@@ -111,6 +138,29 @@ public:
         return *this;
     }
 
+    template<auto Getter, typename Entity>
+    QOrmQueryBuilder& order(QOrmProperty<Getter, Entity> property,
+                            Qt::SortOrder direction = Qt::AscendingOrder)
+    {
+        static_assert(std::is_same_v<T, QObject> || std::is_base_of_v<Entity, T>,
+                      "The property does not belong to the projection of the query");
+
+        m_helper.addOrder(property.mapping(), direction);
+        return *this;
+    }
+
+    QOrmQueryBuilder& limit(int limit)
+    {
+        m_helper.setLimit(limit);
+        return *this;
+    }
+
+    QOrmQueryBuilder& offset(int offset)
+    {
+        m_helper.setOffset(offset);
+        return *this;
+    }
+
     QOrmQueryBuilder& instance(const QMetaObject& qMetaObject, QObject* instance)
     {
         m_helper.setInstance(qMetaObject, instance);
@@ -118,7 +168,75 @@ public:
     }
 
     Q_REQUIRED_RESULT
-    QOrmQueryResult<Projection> select(QOrm::QueryFlags flags = QOrm::QueryFlags::None) const { return m_helper.select(flags); }
+    QOrmQueryResult<Projection> select(QOrm::QueryFlags flags = QOrm::QueryFlags::None) const
+    {
+        QOrmQueryResult<QObject> result = m_helper.select(flags);
+
+        // all instances have the type of the projection, the result can be reused without checks
+        if (m_helper.projectionInherits(Projection::staticMetaObject))
+            return QOrmQueryResult<Projection>::fromKnownProjection(std::move(result));
+
+        return std::move(result);
+    }
+
+    // Number of instances matching the filter, regardless of limit and offset. Returns -1 on error.
+    Q_REQUIRED_RESULT
+    int count() const { return m_helper.count(); }
+
+    // Reads the matching rows into a Q_GADGET with properties named like the properties of the
+    // projection. The rows are not entity instances: they are neither cached nor tracked, and
+    // references are read as the object ID of the referenced instance. Returns an empty vector on
+    // error, see QOrmSession::lastError().
+    template<typename Row>
+    Q_REQUIRED_RESULT std::vector<Row> selectAs() const
+    {
+        static_assert(std::is_default_constructible_v<Row>,
+                      "The row type must be default-constructible");
+
+        std::vector<std::pair<QMetaProperty, int>> columns =
+            m_helper.gadgetColumns(Row::staticMetaObject);
+        std::vector<Row> rows;
+
+        QOrmError error = m_helper.readValues([&rows, &columns](const QVector<QVariant>& values) {
+            Row& row = rows.emplace_back();
+
+            for (const auto& [property, index] : columns)
+                property.writeOnGadget(&row, values[index]);
+        });
+
+        if (error.type() != QOrm::ErrorType::None)
+            rows.clear();
+
+        return rows;
+    }
+
+    // Reads the values of the given properties of the matching rows column by column, e.g.
+    // selectColumns(Q_ORM_PROPERTY(Community, population), Q_ORM_PROPERTY(Community, latitude)).
+    // Returns an empty batch on error, see QOrmSession::lastError().
+    template<typename... Properties>
+    Q_REQUIRED_RESULT QOrmColumnBatch<typename Properties::ValueType...> selectColumns(
+        Properties... properties) const
+    {
+        static_assert(sizeof...(Properties) > 0, "At least one property must be selected");
+        static_assert(((std::is_same_v<T, QObject> ||
+                        std::is_base_of_v<typename Properties::EntityType, T>) && ...),
+                      "The properties do not belong to the projection of the query");
+        static_assert((!std::is_pointer_v<typename Properties::ValueType> && ...),
+                      "References and relations cannot be selected as columns");
+
+        std::array<int, sizeof...(Properties)> indices{
+            m_helper.propertyMappingIndex(properties.classPropertyName())...};
+        QOrmColumnBatch<typename Properties::ValueType...> batch;
+
+        QOrmError error = m_helper.readValues([&batch, &indices](const QVector<QVariant>& values) {
+            batch.append(values, indices);
+        });
+
+        if (error.type() != QOrm::ErrorType::None)
+            batch.clear();
+
+        return batch;
+    }
 
     Q_REQUIRED_RESULT
     QOrmQuery build(QOrm::Operation operation, QOrm::QueryFlags flags = QOrm::QueryFlags::None) const { return m_helper.build(operation, flags); }
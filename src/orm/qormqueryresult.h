@@ -29,14 +29,26 @@
 #include <QtCore/qvariant.h>
 #include <QtCore/qvector.h>
 
+#include <utility>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QOrmError;
 class QOrmQueryResultPrivate;
 
+template<typename T>
+class QOrmQueryBuilder;
+
 template<typename T>
 class QOrmQueryResult
 {
+    template<typename>
+    friend class QOrmQueryResult;
+
+    template<typename>
+    friend class QOrmQueryBuilder;
+
 public:
     using Projection = T;
     static_assert(std::is_convertible_v<Projection*, QObject*>,
@@ -53,6 +65,16 @@ public:
     {
     }
 
+    // Takes over the instances of a result with the same projection. Instances that are not of
+    // type T are replaced with nullptr, as in the copying conversion.
+    template<typename U>
+    QOrmQueryResult(QOrmQueryResult<U>&& other)
+        : m_error{std::move(other.m_error)}
+        , m_result{castVector<U, T>(std::move(other.m_result), true)}
+        , m_lastInsertedId{std::move(other.m_lastInsertedId)}
+    {
+    }
+
     explicit QOrmQueryResult(const QOrmError& error,
                              const QVector<T*>& result,
                              const QVariant& lastInsertedId)
@@ -109,6 +131,34 @@ public:
 
         return m_result.toStdVector();
     }
+
+    // Moves the instances out of the result instead of copying them
+    Q_REQUIRED_RESULT
+    QVector<Projection*> takeVector() &&
+    {
+        if (m_error.type() != QOrm::ErrorType::None)
+        {
+            qFatal("qtorm: QOrmQueryResult::takeVector() has been called but the result contains "
+                   "an error: %s",
+                   qPrintable(m_error.text()));
+        }
+
+        return std::move(m_result);
+    }
+
+    Q_REQUIRED_RESULT
+    std::vector<Projection*> takeStdVector() &&
+    {
+        if (m_error.type() != QOrm::ErrorType::None)
+        {
+            qFatal("qtorm: QOrmQueryResult::takeStdVector() has been called but the result "
+                   "contains an error: %s",
+                   qPrintable(m_error.text()));
+        }
+
+        QVector<Projection*> result = std::move(m_result);
+        return std::vector<Projection*>(result.cbegin(), result.cend());
+    }
     Q_REQUIRED_RESULT
     QSet<Projection*> toSet() const
     {
@@ -120,6 +170,7 @@ public:
         }
 
         QSet<Projection*> result;
+        result.reserve(m_result.size());
 
         for (Projection* instance : m_result)
             result.insert(instance);
@@ -140,6 +191,49 @@ private:
         return to;
     }
 
+    // Takes over the vector of a result with the same projection. Vectors of other pointer types
+    // are unrelated types, so their instances are converted one by one; when the instances are
+    // known to be of type To, without qobject_cast.
+    template<typename From, typename To>
+    static QVector<To*> castVector(QVector<From*>&& from, bool checked)
+    {
+        if constexpr (std::is_same_v<From, To>)
+        {
+            return std::move(from);
+        }
+        else
+        {
+            QVector<To*> to;
+            to.reserve(from.size());
+
+            for (From* instance : from)
+            {
+                if (checked && !std::is_base_of_v<To, From>)
+                {
+                    to.push_back(qobject_cast<To*>(instance));
+                }
+                else
+                {
+                    Q_ASSERT(instance == nullptr || qobject_cast<To*>(instance) != nullptr);
+                    to.push_back(static_cast<To*>(static_cast<QObject*>(instance)));
+                }
+            }
+
+            from.clear();
+
+            return to;
+        }
+    }
+
+    // Used when the projection of the query is known to be T
+    template<typename U>
+    static QOrmQueryResult fromKnownProjection(QOrmQueryResult<U>&& other)
+    {
+        return QOrmQueryResult{std::move(other.m_error),
+                               castVector<U, T>(std::move(other.m_result), false),
+                               std::move(other.m_lastInsertedId)};
+    }
+
     QOrmError m_error;
     QVector<Projection*> m_result;
     QVariant m_lastInsertedId;
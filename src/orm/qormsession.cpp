@@ -23,6 +23,8 @@
 #include "qormabstractprovider.h"
 #include "qormentityinstancecache.h"
 #include "qormerror.h"
+#include "qormfilter.h"
+#include "qormfilterexpression.h"
 #include "qormglobal_p.h"
 #include "qormmetadatacache.h"
 #include "qormorder.h"
@@ -31,14 +33,67 @@
 #include "qormsessionconfiguration.h"
 #include "qormtransactiontoken.h"
 
+#include <QCoreApplication>
 #include <QDebug>
-#include <QScopeGuard>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
+class QOrmBackgroundTask : public QRunnable
+{
+public:
+    explicit QOrmBackgroundTask(std::function<void()> task)
+        : m_task{std::move(task)}
+    {
+    }
+
+    void run() override { m_task(); }
+
+private:
+    std::function<void()> m_task;
+};
+
 class QOrmSessionPrivate
 {
-    using TrackedEntityInstance = std::pair<QObject*, QOrm::Operation>;
+    // State of an entity instance before it was first written in the current transaction. An
+    // instance without values is read from the database again on rollback.
+    struct TrackedEntityInstance
+    {
+        QObject* instance{nullptr};
+        QOrm::Operation operation{QOrm::Operation::Update};
+        QOrmMetadata entity;
+        QVector<QVariant> values;
+    };
+
+    struct PendingMerge
+    {
+        QObject* instance{nullptr};
+        QOrmMetadata entity;
+        QOrm::MergeMode mode{QOrm::MergeMode::Auto};
+    };
+
+    struct BackgroundRead
+    {
+        QPointer<QObject> context;
+        QOrmSession::BackgroundReadHandler handler;
+        std::shared_ptr<std::atomic_bool> isCancelled;
+    };
+
+    using HydratedInstances = std::vector<std::pair<QObject*, QOrmMetadata>>;
+
+    struct EntityChangeListener
+    {
+        QString className;
+        QPointer<QObject> context;
+        QOrmSession::EntityChangeHandler handler;
+    };
 
     Q_DECLARE_PUBLIC(QOrmSession)
     QOrmSession* q_ptr{nullptr};
@@ -46,9 +101,26 @@ class QOrmSessionPrivate
     QOrmEntityInstanceCache m_entityInstanceCache;
     QOrmError m_lastError{QOrm::ErrorType::None, {}};
     QOrmMetadataCache m_metadataCache;
-    QSet<const QObject*> m_mergingInstances;
+    // merges deferred until the next flush, in the order they were requested
+    std::vector<PendingMerge> m_pendingMerges;
+    QHash<const QObject*, QOrm::MergeMode> m_pendingMergeModes;
     int m_transactionCounter{0};
     std::vector<TrackedEntityInstance> m_trackedInstances;
+    // position of the most recent snapshot of a merged instance in m_trackedInstances
+    QHash<const QObject*, size_t> m_trackedMergedInstances;
+    // number of tracked instances when each nested transaction has started
+    std::vector<size_t> m_savepoints;
+    // Background reads run one after another on a single thread that owns the connection of the
+    // background provider. Their results are delivered through the receiver.
+    QThreadPool m_backgroundPool;
+    std::unique_ptr<QOrmAbstractProvider> m_backgroundProvider;
+    bool m_isBackgroundProviderCreated{false};
+    QObject m_backgroundReceiver;
+    QHash<int, BackgroundRead> m_backgroundReads;
+    int m_lastBackgroundReadId{0};
+    // listeners in the order they have been added
+    std::map<int, EntityChangeListener> m_entityChangeListeners;
+    int m_lastEntityChangeListenerId{0};
 
     explicit QOrmSessionPrivate(QOrmSessionConfiguration sessionConfiguration, QOrmSession* parent);
     ~QOrmSessionPrivate();
@@ -57,14 +129,49 @@ class QOrmSessionPrivate
 
     bool needsMerge(const QObject* instance)
     {
-        return instance != nullptr &&
-               (!m_entityInstanceCache.contains(instance) ||
-                m_entityInstanceCache.isModified(instance)) &&
-               !m_mergingInstances.contains(instance);
+        return instance != nullptr && (!m_entityInstanceCache.contains(instance) ||
+                                       m_entityInstanceCache.isModified(instance));
     }
 
+    void enqueueMerge(QObject* instance, const QOrmMetadata& entity, QOrm::MergeMode mode);
+    void discardPendingMerges();
+    void collectMerges(QObject* instance,
+                       const QOrmMetadata& entity,
+                       const QHash<const QObject*, QOrm::MergeMode>& modes,
+                       QSet<const QObject*>& visitedInstances,
+                       std::vector<PendingMerge>& merges);
+    bool flush();
+    bool write(const PendingMerge& merge, QOrm::Operation operation);
+
+    static int entityRank(const QOrmMetadata& entity, QHash<QString, int>& ranks);
+
+    TrackedEntityInstance snapshot(QObject* instance,
+                                   const QOrmMetadata& entity,
+                                   QOrm::Operation operation) const;
+    void track(TrackedEntityInstance trackedInstance);
+    void restore(const TrackedEntityInstance& trackedInstance);
+    void reread(QObject* instance, const QOrmMetadata& entity);
+    bool exists(const QObject* instance, const QOrmMetadata& entity);
+
     void commitTrackedInstances();
-    void rollbackTrackedInstances();
+    void rollbackTrackedInstances(size_t first = 0);
+
+    Q_REQUIRED_RESULT
+    static QString savepointName(int transactionDepth)
+    {
+        return QStringLiteral("qtorm_savepoint_%1").arg(transactionDepth);
+    }
+
+    void finishBackgroundRead(int id,
+                              const QOrmError& error,
+                              QVector<QObject*> resultSet,
+                              const QVariant& value,
+                              const HydratedInstances& hydratedInstances,
+                              bool isResultPinned);
+    QHash<QObject*, QObject*> adopt(const HydratedInstances& hydratedInstances);
+    void stopBackgroundReads();
+
+    void publishChange(QOrm::Operation operation, QObject* instance, const QOrmMetadata& entity);
 
     void clearLastError();
     void setLastError(QOrmError lastError);
@@ -75,6 +182,11 @@ QOrmSessionPrivate::QOrmSessionPrivate(QOrmSessionConfiguration sessionConfigura
     : q_ptr{parent}
     , m_sessionConfiguration{std::move(sessionConfiguration)}
 {
+    m_entityInstanceCache.setMaximumSize(m_sessionConfiguration.entityInstanceCacheSize());
+
+    m_backgroundPool.setMaxThreadCount(1);
+    // the connection of the background provider belongs to the thread it was opened in
+    m_backgroundPool.setExpiryTimeout(-1);
 }
 
 QOrmSessionPrivate::~QOrmSessionPrivate() = default;
@@ -85,42 +197,651 @@ void QOrmSessionPrivate::ensureProviderConnected()
         m_sessionConfiguration.provider()->connectToBackend();
 }
 
+void QOrmSessionPrivate::enqueueMerge(QObject* instance,
+                                      const QOrmMetadata& entity,
+                                      QOrm::MergeMode mode)
+{
+    // repeated merges of the same instance are coalesced into a single write, an upsert wins
+    auto it = m_pendingMergeModes.find(instance);
+
+    if (it != std::end(m_pendingMergeModes))
+    {
+        if (mode == QOrm::MergeMode::Upsert)
+            *it = mode;
+
+        return;
+    }
+
+    m_pendingMergeModes.insert(instance, mode);
+    m_pendingMerges.push_back(PendingMerge{instance, entity, mode});
+}
+
+void QOrmSessionPrivate::discardPendingMerges()
+{
+    std::vector<PendingMerge> merges;
+    QSet<const QObject*> visitedInstances;
+
+    for (const PendingMerge& pendingMerge : m_pendingMerges)
+    {
+        collectMerges(pendingMerge.instance,
+                      pendingMerge.entity,
+                      m_pendingMergeModes,
+                      visitedInstances,
+                      merges);
+    }
+
+    m_pendingMerges.clear();
+    m_pendingMergeModes.clear();
+
+    // Persistent instances that would have been written return to their persisted values, as if
+    // they had been written and rolled back. New instances are left as they are.
+    for (const PendingMerge& merge : merges)
+    {
+        if (!m_entityInstanceCache.contains(merge.instance))
+            continue;
+
+        QVector<QVariant> values = m_entityInstanceCache.persistedValues(merge.instance);
+        restore(TrackedEntityInstance{
+            merge.instance, QOrm::Operation::Update, merge.entity, std::move(values)});
+    }
+}
+
+void QOrmSessionPrivate::collectMerges(QObject* instance,
+                                       const QOrmMetadata& entity,
+                                       const QHash<const QObject*, QOrm::MergeMode>& modes,
+                                       QSet<const QObject*>& visitedInstances,
+                                       std::vector<PendingMerge>& merges)
+{
+    if (visitedInstances.contains(instance))
+        return;
+
+    visitedInstances.insert(instance);
+
+    if (!needsMerge(instance))
+        return;
+
+    if (auto result = QOrmPrivate::crossReferenceError(entity, instance))
+    {
+        qFatal("QtOrm: %s", result->toUtf8().data());
+    }
+
+    // Referenced instances go first so that their object IDs are known when this one is written
+    for (const QOrmPropertyMapping& mapping : entity.propertyMappings())
+    {
+        if (!mapping.isReference() || mapping.isTransient())
+            continue;
+
+        QObject* referencedInstance =
+            QOrmPrivate::propertyValue(instance, mapping).value<QObject*>();
+
+        if (referencedInstance != nullptr)
+        {
+            collectMerges(referencedInstance,
+                          *mapping.referencedEntity(),
+                          modes,
+                          visitedInstances,
+                          merges);
+        }
+    }
+
+    merges.push_back(
+        PendingMerge{instance, entity, modes.value(instance, QOrm::MergeMode::Auto)});
+}
+
+int QOrmSessionPrivate::entityRank(const QOrmMetadata& entity, QHash<QString, int>& ranks)
+{
+    auto it = ranks.find(entity.className());
+
+    if (it != std::end(ranks))
+        return *it;
+
+    // an entity under evaluation has rank 0, this breaks reference cycles
+    ranks.insert(entity.className(), 0);
+
+    int rank = 0;
+
+    for (const QOrmPropertyMapping& mapping : entity.propertyMappings())
+    {
+        if (mapping.isReference() && !mapping.isTransient())
+            rank = qMax(rank, entityRank(*mapping.referencedEntity(), ranks) + 1);
+    }
+
+    ranks.insert(entity.className(), rank);
+    return rank;
+}
+
+bool QOrmSessionPrivate::flush()
+{
+    if (m_pendingMerges.empty())
+        return true;
+
+    std::vector<PendingMerge> pendingMerges;
+    std::swap(pendingMerges, m_pendingMerges);
+    QHash<const QObject*, QOrm::MergeMode> modes;
+    std::swap(modes, m_pendingMergeModes);
+
+    if (m_sessionConfiguration.isVerbose())
+        qCDebug(qtorm) << "Flushing" << pendingMerges.size() << "pending merges";
+
+    std::vector<PendingMerge> merges;
+    QSet<const QObject*> visitedInstances;
+
+    for (const PendingMerge& pendingMerge : pendingMerges)
+    {
+        collectMerges(
+            pendingMerge.instance, pendingMerge.entity, modes, visitedInstances, merges);
+    }
+
+    // Detached instances merged as upserts are written together with the new instances: both
+    // become persistent and receive their object IDs from the database
+    std::vector<PendingMerge> creates;
+    std::vector<PendingMerge> updates;
+
+    for (PendingMerge& merge : merges)
+    {
+        if (m_entityInstanceCache.contains(merge.instance))
+            updates.push_back(std::move(merge));
+        else
+            creates.push_back(std::move(merge));
+    }
+
+    // Write referenced entities first and group the statements per entity, so that the provider
+    // can reuse prepared statements. The stable sort keeps the dependency order of instances of
+    // the same entity.
+    QHash<QString, int> ranks;
+    auto byEntity = [&ranks](const PendingMerge& lhs, const PendingMerge& rhs) {
+        int lhsRank = entityRank(lhs.entity, ranks);
+        int rhsRank = entityRank(rhs.entity, ranks);
+
+        return lhsRank < rhsRank ||
+               (lhsRank == rhsRank && lhs.entity.className() < rhs.entity.className());
+    };
+
+    std::stable_sort(std::begin(creates), std::end(creates), byEntity);
+    std::stable_sort(std::begin(updates), std::end(updates), byEntity);
+
+    QHash<const QObject*, size_t> createdInstances;
+
+    // On failure, the merges stay pending: they are written by the next flush or restored by the
+    // rollback. Instances written in the meantime do not need another merge.
+    auto keepPending = [this, &pendingMerges, &modes]() {
+        std::swap(m_pendingMerges, pendingMerges);
+        std::swap(m_pendingMergeModes, modes);
+        return false;
+    };
+
+    for (size_t i = 0; i < creates.size(); ++i)
+    {
+        QOrm::Operation operation = creates[i].mode == QOrm::MergeMode::Upsert
+                                        ? QOrm::Operation::Merge
+                                        : QOrm::Operation::Create;
+
+        if (!write(creates[i], operation))
+            return keepPending();
+
+        createdInstances.insert(creates[i].instance, i);
+    }
+
+    // Instances in a reference cycle were inserted before some of their referenced instances had
+    // an object ID; write their references again.
+    for (size_t i = 0; i < creates.size(); ++i)
+    {
+        for (const QOrmPropertyMapping& mapping : creates[i].entity.propertyMappings())
+        {
+            if (!mapping.isReference() || mapping.isTransient())
+                continue;
+
+            QObject* referencedInstance =
+                QOrmPrivate::propertyValue(creates[i].instance, mapping).value<QObject*>();
+
+            if (createdInstances.value(referencedInstance, 0) > i)
+            {
+                updates.push_back(creates[i]);
+                break;
+            }
+        }
+    }
+
+    for (const PendingMerge& update : updates)
+    {
+        if (!write(update, QOrm::Operation::Update))
+            return keepPending();
+    }
+
+    return true;
+}
+
+bool QOrmSessionPrivate::write(const PendingMerge& merge, QOrm::Operation operation)
+{
+    if (operation == QOrm::Operation::Merge)
+    {
+        // the session cannot hold two instances of the same entity
+        QVariant objectId = QOrmPrivate::objectIdPropertyValue(merge.instance, merge.entity);
+        QObject* cachedInstance = m_entityInstanceCache.get(merge.entity, objectId);
+
+        if (cachedInstance != nullptr && cachedInstance != merge.instance)
+        {
+            setLastError({QOrm::ErrorType::UnsynchronizedEntity,
+                          QStringLiteral("Another instance of %1 with object ID %2 is already "
+                                         "loaded in the session")
+                              .arg(merge.entity.className(), objectId.toString())});
+            return false;
+        }
+    }
+
+    auto trackedInstance = snapshot(merge.instance, merge.entity, operation);
+
+    QOrmQueryResult result = m_sessionConfiguration.provider()->execute(
+        QOrmQuery{operation, merge.entity, merge.instance},
+        m_entityInstanceCache);
+
+    setLastError(result.error());
+
+    if (m_lastError.type() != QOrm::ErrorType::None)
+        return false;
+
+    track(std::move(trackedInstance));
+
+    if (operation == QOrm::Operation::Create || operation == QOrm::Operation::Merge)
+    {
+        const QOrmPropertyMapping* objectIdMapping = merge.entity.objectIdMapping();
+
+        if (objectIdMapping != nullptr && objectIdMapping->isAutogenerated())
+        {
+            if (!QOrmPrivate::setPropertyValue(merge.instance,
+                                               *objectIdMapping,
+                                               result.lastInsertedId()))
+            {
+                Q_ORM_UNEXPECTED_STATE;
+            }
+        }
+
+        m_entityInstanceCache.insert(merge.entity, merge.instance);
+        m_entityInstanceCache.finalize(merge.entity, merge.instance);
+    }
+    else
+    {
+        m_entityInstanceCache.markUnmodified(merge.instance);
+    }
+
+    publishChange(operation, merge.instance, merge.entity);
+
+    return true;
+}
+
+QOrmSessionPrivate::TrackedEntityInstance
+QOrmSessionPrivate::snapshot(QObject* instance,
+                             const QOrmMetadata& entity,
+                             QOrm::Operation operation) const
+{
+    TrackedEntityInstance trackedInstance{instance, operation, entity, {}};
+
+    // A persistent instance has been modified before it is written: it returns to the values
+    // recorded by the cache when it was last read or written. A new instance returns to its
+    // current state, without the object ID assigned by the database.
+    if (m_entityInstanceCache.contains(instance))
+    {
+        trackedInstance.values = m_entityInstanceCache.persistedValues(instance);
+        return trackedInstance;
+    }
+
+    trackedInstance.values.reserve(static_cast<int>(entity.propertyMappings().size()));
+
+    for (const QOrmPropertyMapping& mapping : entity.propertyMappings())
+    {
+        trackedInstance.values.push_back(mapping.isTransient()
+                                             ? QVariant{}
+                                             : QOrmPrivate::propertyValue(instance, mapping));
+    }
+
+    return trackedInstance;
+}
+
+void QOrmSessionPrivate::track(TrackedEntityInstance trackedInstance)
+{
+    // Only the state before the first write in the innermost transaction is relevant for a
+    // rollback
+    if (trackedInstance.operation != QOrm::Operation::Delete)
+    {
+        size_t first = m_savepoints.empty() ? 0 : m_savepoints.back();
+        auto it = m_trackedMergedInstances.find(trackedInstance.instance);
+
+        if (it != std::end(m_trackedMergedInstances) && *it >= first)
+            return;
+
+        m_trackedMergedInstances.insert(trackedInstance.instance, m_trackedInstances.size());
+    }
+
+    m_trackedInstances.push_back(std::move(trackedInstance));
+}
+
+void QOrmSessionPrivate::restore(const TrackedEntityInstance& trackedInstance)
+{
+    QObject* instance = trackedInstance.instance;
+    const auto& mappings = trackedInstance.entity.propertyMappings();
+
+    // An upsert of a row that still exists has updated it: the instance stays persistent and
+    // takes the values of the row again
+    if (trackedInstance.operation == QOrm::Operation::Merge &&
+        exists(instance, trackedInstance.entity))
+    {
+        reread(instance, trackedInstance.entity);
+        publishChange(QOrm::Operation::Update, instance, trackedInstance.entity);
+        return;
+    }
+
+    switch (trackedInstance.operation)
+    {
+        case QOrm::Operation::Create:
+        case QOrm::Operation::Merge:
+            // the instance is not persistent anymore: return it to the user with its previous
+            // object ID
+            m_entityInstanceCache.take(instance);
+            break;
+
+        case QOrm::Operation::Delete:
+            m_entityInstanceCache.insert(trackedInstance.entity, instance);
+            m_entityInstanceCache.finalize(trackedInstance.entity, instance);
+            break;
+
+        default:
+            break;
+    }
+
+    if (trackedInstance.values.isEmpty())
+    {
+        reread(instance, trackedInstance.entity);
+    }
+    else
+    {
+        for (size_t i = 0; i < mappings.size(); ++i)
+        {
+            if (mappings[i].isTransient())
+                continue;
+
+            if (!QOrmPrivate::setPropertyValue(instance,
+                                               mappings[i],
+                                               trackedInstance.values[static_cast<int>(i)]))
+            {
+                Q_ORM_UNEXPECTED_STATE;
+            }
+        }
+    }
+
+    // the instance matches the database again
+    if (trackedInstance.operation != QOrm::Operation::Create &&
+        trackedInstance.operation != QOrm::Operation::Merge)
+    {
+        m_entityInstanceCache.markUnmodified(instance);
+    }
+
+    // the listeners undo the change as well
+    switch (trackedInstance.operation)
+    {
+        case QOrm::Operation::Create:
+        case QOrm::Operation::Merge:
+            publishChange(QOrm::Operation::Delete, instance, trackedInstance.entity);
+            break;
+
+        case QOrm::Operation::Delete:
+            publishChange(QOrm::Operation::Create, instance, trackedInstance.entity);
+            break;
+
+        default:
+            publishChange(QOrm::Operation::Update, instance, trackedInstance.entity);
+            break;
+    }
+}
+
+void QOrmSessionPrivate::reread(QObject* instance, const QOrmMetadata& entity)
+{
+    QOrmFilter filter{*entity.objectIdMapping() ==
+                      QOrmPrivate::objectIdPropertyValue(instance, entity)};
+    QOrmQuery query{QOrm::Operation::Read,
+                    QOrmRelation{entity},
+                    entity,
+                    filter,
+                    {},
+                    QOrm::QueryFlags::OverwriteCachedInstances};
+    QOrmQueryResult result =
+        m_sessionConfiguration.provider()->execute(query, m_entityInstanceCache);
+
+    if (result.error().type() != QOrm::ErrorType::None)
+        qFatal("QtOrm: Inconsistent state: unable to rollback tracked instances.");
+}
+
+bool QOrmSessionPrivate::exists(const QObject* instance, const QOrmMetadata& entity)
+{
+    QOrmFilter filter{*entity.objectIdMapping() ==
+                      QOrmPrivate::objectIdPropertyValue(instance, entity)};
+    QOrmQuery query{QOrm::Operation::Count,
+                    QOrmRelation{entity},
+                    entity,
+                    filter,
+                    {},
+                    QOrm::QueryFlags::None};
+    QOrmQueryResult result =
+        m_sessionConfiguration.provider()->execute(query, m_entityInstanceCache);
+
+    if (result.error().type() != QOrm::ErrorType::None)
+        qFatal("QtOrm: Inconsistent state: unable to rollback tracked instances.");
+
+    return result.lastInsertedId().toInt() > 0;
+}
+
 void QOrmSessionPrivate::commitTrackedInstances()
 {
-    for (auto& [instance, operation] : m_trackedInstances)
+    // The session owns the removed instances, they are deleted right away: without an event loop,
+    // deleteLater() would keep them until the thread ends. An instance merged again after its
+    // removal is in the cache again and is kept.
+    QSet<QObject*> removedInstances;
+
+    for (const TrackedEntityInstance& trackedInstance : m_trackedInstances)
     {
-        if (operation == QOrm::Operation::Delete)
-            instance->deleteLater();
+        if (trackedInstance.operation == QOrm::Operation::Delete &&
+            !m_entityInstanceCache.contains(trackedInstance.instance))
+        {
+            removedInstances.insert(trackedInstance.instance);
+        }
     }
 
+    qDeleteAll(removedInstances);
+
     m_trackedInstances.clear();
+    m_trackedMergedInstances.clear();
 }
 
-void QOrmSessionPrivate::rollbackTrackedInstances()
+void QOrmSessionPrivate::rollbackTrackedInstances(size_t first)
 {
-    for (auto& [instance, operation] : m_trackedInstances)
+    // Restore in reverse order so that an instance touched several times ends up in the state it
+    // had before the transaction
+    for (size_t i = m_trackedInstances.size(); i > first; --i)
+        restore(m_trackedInstances[i - 1]);
+
+    m_trackedInstances.erase(std::begin(m_trackedInstances) + static_cast<ptrdiff_t>(first),
+                             std::end(m_trackedInstances));
+
+    m_trackedMergedInstances.clear();
+    for (size_t i = 0; i < m_trackedInstances.size(); ++i)
     {
-        Q_UNUSED(operation)
+        if (m_trackedInstances[i].operation != QOrm::Operation::Delete)
+            m_trackedMergedInstances.insert(m_trackedInstances[i].instance, i);
+    }
+}
 
-        QOrmMetadata relation = m_metadataCache.get(*instance->metaObject());
-        QOrmMetadata projection = relation;
-        QOrmFilter filter{*relation.objectIdMapping() ==
-                          QOrmPrivate::objectIdPropertyValue(instance, relation)};
+void QOrmSessionPrivate::finishBackgroundRead(int id,
+                                              const QOrmError& error,
+                                              QVector<QObject*> resultSet,
+                                              const QVariant& value,
+                                              const HydratedInstances& hydratedInstances,
+                                              bool isResultPinned)
+{
+    BackgroundRead backgroundRead = m_backgroundReads.take(id);
 
-        QOrmQuery query{QOrm::Operation::Read,
-                        QOrmRelation{relation},
-                        projection,
-                        filter,
-                        {},
-                        QOrm::QueryFlags::OverwriteCachedInstances};
-        QOrmQueryResult result =
-            m_sessionConfiguration.provider()->execute(query, m_entityInstanceCache);
+    if (!backgroundRead.context.isNull())
+    {
+        if (!hydratedInstances.empty())
+        {
+            QHash<QObject*, QObject*> replacements = adopt(hydratedInstances);
+
+            for (QObject*& instance : resultSet)
+                instance = replacements.value(instance, instance);
+        }
 
-        if (result.error().type() != QOrm::ErrorType::None)
-            qFatal("QtOrm: Inconsistent state: unable to rollback tracked instances.");
+        backgroundRead.handler(QOrmQueryResult<QObject>{error, resultSet, value});
+    }
+    // cancelled or the context is gone: the instances read by the worker are not needed
+    else
+    {
+        for (const auto& [instance, entity] : hydratedInstances)
+        {
+            Q_UNUSED(entity)
+            delete instance;
+        }
     }
 
-    m_trackedInstances.clear();
+    if (isResultPinned)
+    {
+        for (const QObject* instance : qAsConst(resultSet))
+            m_entityInstanceCache.unpin(instance);
+    }
+}
+
+QHash<QObject*, QObject*> QOrmSessionPrivate::adopt(const HydratedInstances& hydratedInstances)
+{
+    // Instances already loaded in the session take precedence over the ones read by the worker,
+    // even if they have unsaved changes
+    QHash<QObject*, QObject*> replacements;
+    replacements.reserve(static_cast<int>(hydratedInstances.size()));
+
+    for (const auto& [instance, entity] : hydratedInstances)
+    {
+        QObject* cachedInstance =
+            m_entityInstanceCache.get(entity, QOrmPrivate::objectIdPropertyValue(instance, entity));
+
+        replacements.insert(instance, cachedInstance != nullptr ? cachedInstance : instance);
+    }
+
+    for (const auto& [instance, entity] : hydratedInstances)
+    {
+        if (replacements.value(instance) != instance)
+            continue;
+
+        // re-link references to instances that are replaced
+        for (const QOrmPropertyMapping& mapping : entity.propertyMappings())
+        {
+            if (!mapping.isReference())
+                continue;
+
+            QVariant value = QOrmPrivate::propertyValue(instance, mapping);
+
+            if (mapping.isTransient())
+            {
+                auto referencedInstances = value.value<QVector<QObject*>>();
+                bool isRelinked = false;
+
+                for (QObject*& referencedInstance : referencedInstances)
+                {
+                    QObject* replacement = replacements.value(referencedInstance,
+                                                              referencedInstance);
+                    isRelinked = isRelinked || replacement != referencedInstance;
+                    referencedInstance = replacement;
+                }
+
+                if (isRelinked &&
+                    !QOrmPrivate::setPropertyValue(instance,
+                                                   mapping,
+                                                   QVariant::fromValue(referencedInstances)))
+                {
+                    Q_ORM_UNEXPECTED_STATE;
+                }
+            }
+            else
+            {
+                QObject* referencedInstance = value.value<QObject*>();
+                QObject* replacement = replacements.value(referencedInstance, referencedInstance);
+
+                if (replacement != referencedInstance &&
+                    !QOrmPrivate::setPropertyValue(instance,
+                                                   mapping,
+                                                   QVariant::fromValue(replacement)))
+                {
+                    Q_ORM_UNEXPECTED_STATE;
+                }
+            }
+        }
+
+        m_entityInstanceCache.insert(entity, instance);
+        m_entityInstanceCache.finalize(entity, instance);
+    }
+
+    for (const auto& [instance, entity] : hydratedInstances)
+    {
+        Q_UNUSED(entity)
+
+        if (replacements.value(instance) != instance)
+            delete instance;
+    }
+
+    return replacements;
+}
+
+void QOrmSessionPrivate::stopBackgroundReads()
+{
+    for (const BackgroundRead& backgroundRead : qAsConst(m_backgroundReads))
+        backgroundRead.isCancelled->store(true);
+
+    m_backgroundReads.clear();
+    m_backgroundPool.waitForDone();
+
+    if (m_backgroundProvider != nullptr)
+    {
+        QOrmAbstractProvider* provider = m_backgroundProvider.get();
+
+        m_backgroundPool.start(new QOrmBackgroundTask{[provider]() {
+            if (provider->isConnectedToBackend())
+                provider->disconnectFromBackend();
+        }});
+        m_backgroundPool.waitForDone();
+        m_backgroundProvider.reset();
+    }
+
+    // results that are still queued release their instances
+    QCoreApplication::sendPostedEvents(&m_backgroundReceiver, QEvent::MetaCall);
+}
+
+void QOrmSessionPrivate::publishChange(QOrm::Operation operation,
+                                       QObject* instance,
+                                       const QOrmMetadata& entity)
+{
+    if (m_entityChangeListeners.empty())
+        return;
+
+    std::vector<int> ids;
+
+    for (const auto& [id, listener] : m_entityChangeListeners)
+    {
+        if (listener.className == entity.className())
+            ids.push_back(id);
+    }
+
+    // a handler may add or remove listeners
+    for (int id : ids)
+    {
+        auto it = m_entityChangeListeners.find(id);
+
+        if (it == std::end(m_entityChangeListeners))
+            continue;
+
+        if (it->second.context.isNull())
+        {
+            m_entityChangeListeners.erase(it);
+            continue;
+        }
+
+        QOrmSession::EntityChangeHandler handler = it->second.handler;
+        handler(operation, instance);
+    }
 }
 
 void QOrmSessionPrivate::clearLastError()
@@ -142,6 +863,8 @@ QOrmSession::~QOrmSession()
 {
     Q_D(QOrmSession);
 
+    d->stopBackgroundReads();
+
     if (d->m_sessionConfiguration.provider()->isConnectedToBackend())
         d->m_sessionConfiguration.provider()->disconnectFromBackend();
 
@@ -155,6 +878,19 @@ QOrmQueryResult<QObject> QOrmSession::execute(const QOrmQuery& query)
     d->clearLastError();
     d->ensureProviderConnected();
 
+    // reads must see the merges requested so far
+    if (!d->flush())
+        return QOrmQueryResult<QObject>{d->m_lastError};
+
+    // Instances changed by other writers are refreshed when they are read. Inside a transaction,
+    // the connection does not see other changes.
+    if (!isTransactionActive())
+        d->m_sessionConfiguration.provider()->detectExternalChanges(d->m_entityInstanceCache);
+
+    // instances can be evicted safely only while no transaction keeps track of them
+    if (!isTransactionActive())
+        d->m_entityInstanceCache.trim();
+
     QOrmQueryResult<QObject> providerResult =
         d->m_sessionConfiguration.provider()->execute(query, d->m_entityInstanceCache);
 
@@ -162,109 +898,237 @@ QOrmQueryResult<QObject> QOrmSession::execute(const QOrmQuery& query)
     return providerResult;
 }
 
-QOrmQueryBuilder<QObject> QOrmSession::from(const QOrmQuery& query)
+QOrmError QOrmSession::readValues(const QOrmQuery& query, const ValueRowHandler& handler)
 {
+    Q_D(QOrmSession);
+
     Q_ASSERT(query.operation() == QOrm::Operation::Read);
 
-    return QOrmQueryBuilder<QObject>{this, QOrmRelation{query}};
-}
+    d->clearLastError();
+    d->ensureProviderConnected();
 
-QOrmQueryBuilder<QObject> QOrmSession::queryBuilderFor(const QMetaObject& relationMetaObject)
-{
-    Q_D(QOrmSession);
+    // reads must see the merges requested so far
+    if (!d->flush())
+        return d->m_lastError;
 
-    return QOrmQueryBuilder<QObject>{this, QOrmRelation{d->m_metadataCache[relationMetaObject]}};
+    QOrmError error = d->m_sessionConfiguration.provider()->readValues(query, handler);
+
+    d->setLastError(error);
+    return error;
 }
 
-bool QOrmSession::doMerge(QObject* entityInstance, const QMetaObject& qMetaObject)
+int QOrmSession::executeInBackground(const QOrmQuery& query,
+                                     QObject* context,
+                                     BackgroundReadHandler handler)
 {
     Q_D(QOrmSession);
 
-    Q_ASSERT(entityInstance != nullptr);
-
-    if (d->m_mergingInstances.contains(entityInstance))
-        return true;
+    Q_ASSERT(query.operation() == QOrm::Operation::Read ||
+             query.operation() == QOrm::Operation::Count);
+    Q_ASSERT(context != nullptr);
 
-    auto token = declareTransaction(QOrm::TransactionPropagation::Require,
-                                    QOrm::TransactionAction::Rollback);
-
-    d->m_mergingInstances.insert(entityInstance);
-
-    auto mergeFinalizer = qScopeGuard([d, entityInstance]() {
-        d->m_mergingInstances.remove(entityInstance);
-        d->m_trackedInstances.push_back(std::make_pair(entityInstance, QOrm::Operation::Merge));
-    });
+    int id = ++d->m_lastBackgroundReadId;
+    auto isCancelled = std::make_shared<std::atomic_bool>(false);
+    d->m_backgroundReads.insert(id, {context, std::move(handler), isCancelled});
 
     d->clearLastError();
     d->ensureProviderConnected();
 
-    QOrm::Operation operation = d->m_entityInstanceCache.contains(entityInstance)
-                                    ? QOrm::Operation::Update
-                                    : QOrm::Operation::Create;
+    if (!d->m_isBackgroundProviderCreated)
+    {
+        d->m_backgroundProvider.reset(
+            d->m_sessionConfiguration.provider()->createBackgroundProvider());
+        d->m_isBackgroundProviderCreated = true;
+
+        if (d->m_backgroundProvider == nullptr && d->m_sessionConfiguration.isVerbose())
+            qCDebug(qtorm) << "The provider does not support background reads";
+    }
 
-    if (operation == QOrm::Operation::Update &&
-        !d->m_entityInstanceCache.isModified(entityInstance))
+    // The worker connection does not see the changes of an active transaction, read them here.
+    // The result is delivered asynchronously all the same.
+    if (d->m_backgroundProvider == nullptr || isTransactionActive())
     {
-        return true;
+        QOrmQueryResult<QObject> result = execute(query);
+        QVector<QObject*> resultSet;
+
+        if (result.error().type() == QOrm::ErrorType::None)
+            resultSet = result.toVector();
+
+        // keep the instances until the handler has taken them over
+        for (const QObject* instance : qAsConst(resultSet))
+            d->m_entityInstanceCache.pin(instance);
+
+        QMetaObject::invokeMethod(
+            &d->m_backgroundReceiver,
+            [d, id, error = result.error(), resultSet, value = result.lastInsertedId()]() {
+                d->finishBackgroundRead(id, error, resultSet, value, {}, true);
+            },
+            Qt::QueuedConnection);
+
+        return id;
     }
 
-    QOrmMetadata entity = d->m_metadataCache[qMetaObject];
+    // the worker connection does not modify the schema
+    QOrmError schemaError =
+        d->m_sessionConfiguration.provider()->synchronizeSchema(query.relation());
 
-    if (auto result = QOrmPrivate::crossReferenceError(entity, entityInstance))
+    if (schemaError.type() != QOrm::ErrorType::None)
     {
-        qFatal("QtOrm: %s", result->toUtf8().data());
+        d->setLastError(schemaError);
+
+        QMetaObject::invokeMethod(
+            &d->m_backgroundReceiver,
+            [d, id, schemaError]() { d->finishBackgroundRead(id, schemaError, {}, {}, {}, false); },
+            Qt::QueuedConnection);
+
+        return id;
     }
 
-    // Merge modified referenced entity instances
-    for (const QOrmPropertyMapping& mapping : entity.propertyMappings())
-    {
-        if (!mapping.isReference() || mapping.isTransient())
-            continue;
+    if (d->m_sessionConfiguration.isVerbose())
+        qCDebug(qtorm) << "Starting background read" << id << query;
 
-        // T*: merge if modified
-        QObject* referencedInstance =
-            QOrmPrivate::propertyValue(entityInstance, mapping).value<QObject*>();
+    QOrmAbstractProvider* provider = d->m_backgroundProvider.get();
+    QThread* sessionThread = d->m_backgroundReceiver.thread();
 
-        if (!d->needsMerge(referencedInstance))
-            continue;
+    d->m_backgroundPool.start(new QOrmBackgroundTask{[d, provider, sessionThread, id, query,
+                                                      isCancelled]() {
+        if (*isCancelled)
+            return;
 
-        if (!doMerge(referencedInstance, *referencedInstance->metaObject()))
-            return false;
-    }
+        QOrmError error{QOrm::ErrorType::None, {}};
 
-    QOrmQueryResult result = d->m_sessionConfiguration.provider()->execute(
-        queryBuilderFor(qMetaObject).instance(qMetaObject, entityInstance).build(operation),
-        d->m_entityInstanceCache);
+        if (!provider->isConnectedToBackend())
+            error = provider->connectToBackend();
 
-    d->setLastError(result.error());
+        // the instances are created and cached in the worker thread first
+        QOrmEntityInstanceCache entityInstanceCache;
+        QVector<QObject*> resultSet;
+        QVariant value;
 
-    if (d->m_lastError.type() == QOrm::ErrorType::None)
-    {
-        if (operation == QOrm::Operation::Create)
+        if (error.type() == QOrm::ErrorType::None)
         {
-            const QOrmPropertyMapping* objectIdMapping =
-                d->m_metadataCache[qMetaObject].objectIdMapping();
+            QOrmQueryResult<QObject> result = provider->execute(query, entityInstanceCache);
+            error = result.error();
 
-            if (objectIdMapping != nullptr && objectIdMapping->isAutogenerated())
+            if (error.type() == QOrm::ErrorType::None)
             {
-                if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                                   objectIdMapping->classPropertyName(),
-                                                   result.lastInsertedId()))
-                {
-                    Q_ORM_UNEXPECTED_STATE;
-                }
+                resultSet = result.toVector();
+                value = result.lastInsertedId();
+            }
+        }
+
+        QOrmSessionPrivate::HydratedInstances hydratedInstances = entityInstanceCache.takeAll();
+
+        if (error.type() != QOrm::ErrorType::None || *isCancelled)
+        {
+            for (const auto& [instance, entity] : hydratedInstances)
+            {
+                Q_UNUSED(entity)
+                delete instance;
             }
 
-            d->m_entityInstanceCache.insert(d->m_metadataCache[qMetaObject], entityInstance);
-            d->m_entityInstanceCache.finalize(d->m_metadataCache[qMetaObject], entityInstance);
+            hydratedInstances.clear();
+            resultSet.clear();
+
+            if (*isCancelled)
+                return;
         }
-        else
-            d->m_entityInstanceCache.markUnmodified(entityInstance);
 
-        token.commit();
+        for (const auto& [instance, entity] : hydratedInstances)
+        {
+            Q_UNUSED(entity)
+            instance->moveToThread(sessionThread);
+        }
+
+        QMetaObject::invokeMethod(
+            &d->m_backgroundReceiver,
+            [d, id, error, resultSet, value, hydratedInstances]() {
+                d->finishBackgroundRead(id, error, resultSet, value, hydratedInstances, false);
+            },
+            Qt::QueuedConnection);
+    }});
+
+    return id;
+}
+
+bool QOrmSession::cancelBackgroundRead(int id)
+{
+    Q_D(QOrmSession);
+
+    auto it = d->m_backgroundReads.find(id);
+
+    if (it == std::end(d->m_backgroundReads))
+        return false;
+
+    it->isCancelled->store(true);
+    d->m_backgroundReads.erase(it);
+
+    return true;
+}
+
+int QOrmSession::addEntityChangeListener(const QMetaObject& qMetaObject,
+                                         QObject* context,
+                                         EntityChangeHandler handler)
+{
+    Q_D(QOrmSession);
+
+    Q_ASSERT(context != nullptr);
+
+    int id = ++d->m_lastEntityChangeListenerId;
+    d->m_entityChangeListeners.emplace(
+        id,
+        QOrmSessionPrivate::EntityChangeListener{d->m_metadataCache[qMetaObject].className(),
+                                                 context,
+                                                 std::move(handler)});
+
+    return id;
+}
+
+bool QOrmSession::removeEntityChangeListener(int id)
+{
+    Q_D(QOrmSession);
+
+    return d->m_entityChangeListeners.erase(id) > 0;
+}
+
+QOrmQueryBuilder<QObject> QOrmSession::from(const QOrmQuery& query)
+{
+    Q_ASSERT(query.operation() == QOrm::Operation::Read);
+
+    return QOrmQueryBuilder<QObject>{this, QOrmRelation{query}};
+}
+
+QOrmQueryBuilder<QObject> QOrmSession::queryBuilderFor(const QMetaObject& relationMetaObject)
+{
+    Q_D(QOrmSession);
+
+    return QOrmQueryBuilder<QObject>{this, QOrmRelation{d->m_metadataCache[relationMetaObject]}};
+}
+
+bool QOrmSession::doMerge(QObject* entityInstance,
+                          const QMetaObject& qMetaObject,
+                          QOrm::MergeMode mode)
+{
+    Q_D(QOrmSession);
+
+    Q_ASSERT(entityInstance != nullptr);
+
+    d->clearLastError();
+
+    // Inside a transaction, the merge is deferred until the next flush. Otherwise, it is written
+    // in a transaction of its own.
+    if (isTransactionActive())
+    {
+        d->enqueueMerge(entityInstance, d->m_metadataCache[qMetaObject], mode);
+        return true;
     }
 
-    return d->m_lastError.type() == QOrm::ErrorType::None;
+    QOrmTransactionToken token = declareTransaction(QOrm::TransactionPropagation::Require,
+                                                    QOrm::TransactionAction::Rollback);
+
+    d->enqueueMerge(entityInstance, d->m_metadataCache[qMetaObject], mode);
+
+    return token.commit();
 }
 
 bool QOrmSession::doRemove(QObject* entityInstance, const QMetaObject& qMetaObject)
@@ -274,6 +1138,9 @@ bool QOrmSession::doRemove(QObject* entityInstance, const QMetaObject& qMetaObje
     d->clearLastError();
     d->ensureProviderConnected();
 
+    if (!d->flush())
+        return false;
+
     QOrmQueryResult result =
         d->m_sessionConfiguration.provider()->execute(queryBuilderFor(qMetaObject)
                                                           .instance(qMetaObject, entityInstance)
@@ -284,7 +1151,20 @@ bool QOrmSession::doRemove(QObject* entityInstance, const QMetaObject& qMetaObje
 
     if (d->m_lastError.type() == QOrm::ErrorType::None)
     {
-        delete d->m_entityInstanceCache.take(entityInstance);
+        d->publishChange(QOrm::Operation::Delete, entityInstance, d->m_metadataCache[qMetaObject]);
+
+        // keep the instance until commit so that a rollback can restore it
+        if (isTransactionActive() && d->m_entityInstanceCache.contains(entityInstance))
+        {
+            d->track(d->snapshot(entityInstance,
+                                 d->m_metadataCache[qMetaObject],
+                                 QOrm::Operation::Delete));
+            d->m_entityInstanceCache.take(entityInstance);
+        }
+        else
+        {
+            delete d->m_entityInstanceCache.take(entityInstance);
+        }
     }
 
     return d->m_lastError.type() == QOrm::ErrorType::None;
@@ -328,6 +1208,32 @@ QOrmError QOrmSession::lastError() const
     return d->m_lastError;
 }
 
+QOrmStatistics QOrmSession::statistics() const
+{
+    Q_D(const QOrmSession);
+
+    QOrmStatistics statistics = d->m_sessionConfiguration.provider()->statistics();
+    statistics.setCacheLookups(d->m_entityInstanceCache.hitCount(),
+                               d->m_entityInstanceCache.missCount());
+
+    return statistics;
+}
+
+void QOrmSession::resetStatistics()
+{
+    Q_D(QOrmSession);
+
+    d->m_sessionConfiguration.provider()->resetStatistics();
+    d->m_entityInstanceCache.resetCounters();
+}
+
+void QOrmSession::setStatementObserver(QOrmStatistics::StatementObserver observer)
+{
+    Q_D(QOrmSession);
+
+    d->m_sessionConfiguration.provider()->setStatementObserver(std::move(observer));
+}
+
 const QOrmSessionConfiguration& QOrmSession::configuration() const
 {
     Q_D(const QOrmSession);
@@ -341,6 +1247,22 @@ QOrmMetadataCache* QOrmSession::metadataCache()
     return &d->m_metadataCache;
 }
 
+QOrmEntityInstanceCache* QOrmSession::entityInstanceCache()
+{
+    Q_D(QOrmSession);
+    return &d->m_entityInstanceCache;
+}
+
+bool QOrmSession::flush()
+{
+    Q_D(QOrmSession);
+
+    d->clearLastError();
+    d->ensureProviderConnected();
+
+    return d->flush();
+}
+
 bool QOrmSession::beginTransaction()
 {
     Q_D(QOrmSession);
@@ -366,10 +1288,30 @@ bool QOrmSession::beginTransaction()
     }
     else
     {
-        d->m_transactionCounter++;
+        // pending merges belong to the enclosing transaction
+        if (!d->flush())
+            return false;
+
+        QString savepoint = QOrmSessionPrivate::savepointName(d->m_transactionCounter + 1);
+
+        if (d->m_sessionConfiguration.isVerbose())
+            qCDebug(qtorm) << "Creating savepoint" << savepoint;
+
+        d->ensureProviderConnected();
+        d->setLastError(d->m_sessionConfiguration.provider()->createSavepoint(savepoint));
+
+        if (d->m_lastError.type() == QOrm::ErrorType::None)
+        {
+            d->m_savepoints.push_back(d->m_trackedInstances.size());
+            d->m_transactionCounter++;
+        }
+        else if (d->m_sessionConfiguration.isVerbose())
+        {
+            qCWarning(qtorm) << "Unable to create savepoint:" << d->m_lastError.text();
+        }
     }
 
-    return d->m_transactionCounter > 0;
+    return d->m_lastError.type() == QOrm::ErrorType::None;
 }
 
 bool QOrmSession::commitTransaction()
@@ -378,6 +1320,19 @@ bool QOrmSession::commitTransaction()
 
     d->setLastError(QOrmError{QOrm::ErrorType::None, {}});
 
+    // a transaction that cannot be flushed is rolled back
+    if (d->m_transactionCounter > 0 && !d->flush())
+    {
+        QOrmError flushError = d->m_lastError;
+
+        if (d->m_sessionConfiguration.isVerbose())
+            qCWarning(qtorm) << "Unable to flush pending merges:" << flushError.text();
+
+        rollbackTransaction();
+        d->setLastError(flushError);
+        return false;
+    }
+
     if (d->m_transactionCounter == 0)
     {
         d->setLastError({QOrm::ErrorType::TransactionNotActive, "Transaction is not active"});
@@ -402,7 +1357,24 @@ bool QOrmSession::commitTransaction()
     }
     else
     {
-        d->m_transactionCounter--;
+        QString savepoint = QOrmSessionPrivate::savepointName(d->m_transactionCounter);
+
+        if (d->m_sessionConfiguration.isVerbose())
+            qCDebug(qtorm) << "Releasing savepoint" << savepoint;
+
+        d->ensureProviderConnected();
+        d->setLastError(d->m_sessionConfiguration.provider()->releaseSavepoint(savepoint));
+
+        // the tracked instances are now part of the enclosing transaction
+        if (d->m_lastError.type() == QOrm::ErrorType::None)
+        {
+            d->m_savepoints.pop_back();
+            d->m_transactionCounter--;
+        }
+        else if (d->m_sessionConfiguration.isVerbose())
+        {
+            qCWarning(qtorm) << "Unable to release savepoint:" << d->m_lastError.text();
+        }
     }
 
     return d->m_lastError.type() == QOrm::ErrorType::None;
@@ -413,6 +1385,7 @@ bool QOrmSession::rollbackTransaction()
     Q_D(QOrmSession);
 
     d->setLastError(QOrmError{QOrm::ErrorType::None, {}});
+    d->discardPendingMerges();
 
     if (d->m_transactionCounter == 0)
     {
@@ -438,7 +1411,24 @@ bool QOrmSession::rollbackTransaction()
     }
     else
     {
-        d->m_transactionCounter--;
+        QString savepoint = QOrmSessionPrivate::savepointName(d->m_transactionCounter);
+
+        if (d->m_sessionConfiguration.isVerbose())
+            qCDebug(qtorm) << "Rolling back to savepoint" << savepoint;
+
+        d->ensureProviderConnected();
+        d->setLastError(d->m_sessionConfiguration.provider()->rollbackToSavepoint(savepoint));
+
+        if (d->m_lastError.type() == QOrm::ErrorType::None)
+        {
+            d->rollbackTrackedInstances(d->m_savepoints.back());
+            d->m_savepoints.pop_back();
+            d->m_transactionCounter--;
+        }
+        else if (d->m_sessionConfiguration.isVerbose())
+        {
+            qCWarning(qtorm) << "Unable to rollback to savepoint:" << d->m_lastError.text();
+        }
     }
 
     return d->m_lastError.type() == QOrm::ErrorType::None;
@@ -27,10 +27,13 @@
 #include <QtOrm/qormquerybuilder.h>
 #include <QtOrm/qormqueryresult.h>
 #include <QtOrm/qormsessionconfiguration.h>
+#include <QtOrm/qormstatistics.h>
 #include <QtOrm/qormtransactiontoken.h>
 
 #include <QtCore/qobject.h>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QOrmAbstractProvider;
@@ -47,6 +50,11 @@ class Q_ORM_EXPORT QOrmSession
     Q_DECLARE_PRIVATE(QOrmSession)
 
 public:
+    using BackgroundReadHandler = std::function<void(QOrmQueryResult<QObject>)>;
+    using ValueRowHandler = std::function<void(const QVector<QVariant>& values)>;
+    using EntityChangeHandler =
+        std::function<void(QOrm::Operation operation, QObject* entityInstance)>;
+
     explicit QOrmSession(
         QOrmSessionConfiguration configuration = QOrmSessionConfiguration::defaultConfiguration());
     ~QOrmSession();
@@ -54,31 +62,65 @@ public:
     Q_REQUIRED_RESULT
     QOrmQueryResult<QObject> execute(const QOrmQuery& query);
 
+    // Executes a read query and calls the handler with the property values of every row, in the
+    // order of the property mappings of the projection. No entity instances are created, and
+    // cached instances are neither returned nor refreshed.
+    QOrmError readValues(const QOrmQuery& query, const ValueRowHandler& handler);
+
     Q_REQUIRED_RESULT
     QOrmQueryBuilder<QObject> from(const QOrmQuery& query);
 
+    // Executes a read or count query on a worker thread and calls the handler in the thread of
+    // the session with the instances adopted by the session. The handler is not called if the
+    // context is destroyed or the read is cancelled. Returns the ID of the read.
+    int executeInBackground(const QOrmQuery& query,
+                            QObject* context,
+                            BackgroundReadHandler handler);
+    bool cancelBackgroundRead(int id);
+
+    // Calls the handler whenever an instance of the entity is written, removed, or restored by a
+    // rollback. The operation is Create, Update, Merge for an upsert, or Delete. The handler is
+    // called synchronously and not after the context is destroyed. Returns the ID of the
+    // listener.
+    int addEntityChangeListener(const QMetaObject& qMetaObject,
+                                QObject* context,
+                                EntityChangeHandler handler);
+    bool removeEntityChangeListener(int id);
+
     template<typename T>
-    bool merge(T* entityInstance)
+    int addEntityChangeListener(QObject* context, EntityChangeHandler handler)
     {
-        return doMerge(entityInstance, T::staticMetaObject);
+        return addEntityChangeListener(T::staticMetaObject, context, std::move(handler));
     }
 
+    // Writes the instance and the instances it references, unless they are persistent and
+    // unmodified. Outside a transaction, the instance is written immediately and the result
+    // reports success. Inside a transaction, the write is deferred until the next flush: merge()
+    // always returns true, object IDs are assigned when the instance is flushed, and errors are
+    // reported by flush(), commitTransaction(), or the next query. A rollback restores the
+    // persisted values of modified instances that have not been flushed yet.
     template<typename T>
-    bool merge(std::initializer_list<T*> instances)
+    bool merge(T* entityInstance, QOrm::MergeMode mode = QOrm::MergeMode::Auto)
+    {
+        return doMerge(entityInstance, T::staticMetaObject, mode);
+    }
+
+    template<typename T>
+    bool merge(std::initializer_list<T*> instances, QOrm::MergeMode mode = QOrm::MergeMode::Auto)
     {
         QOrmTransactionToken token = declareTransaction(QOrm::TransactionPropagation::Require,
                                                         QOrm::TransactionAction::Commit);
 
         for (T* instance : instances)
         {
-            if (!merge(instance))
+            if (!merge(instance, mode))
             {
                 token.rollback();
                 return false;
             }
         }
 
-        return true;
+        return token.commit();
     }
 
     template<typename... Ts>
@@ -93,7 +135,7 @@ public:
             return false;
         }
 
-        return true;
+        return token.commit();
     }
 
     template<typename T>
@@ -121,6 +163,14 @@ public:
     Q_REQUIRED_RESULT
     QOrmError lastError() const;
 
+    // Counters and latencies of the statements executed by the provider of the session and the
+    // lookups in its entity instance cache. Reads in the background are not included.
+    Q_REQUIRED_RESULT
+    QOrmStatistics statistics() const;
+    void resetStatistics();
+    // Called after every statement executed by the provider of the session
+    void setStatementObserver(QOrmStatistics::StatementObserver observer);
+
     Q_REQUIRED_RESULT
     const QOrmSessionConfiguration& configuration() const;
 
@@ -130,13 +180,15 @@ public:
     Q_REQUIRED_RESULT
     QOrmEntityInstanceCache* entityInstanceCache();
 
+    bool flush();
+
     bool beginTransaction();
     bool commitTransaction();
     bool rollbackTransaction();
     bool isTransactionActive() const;
 
 private:
-    bool doMerge(QObject* entityInstance, const QMetaObject& qMetaObject);
+    bool doMerge(QObject* entityInstance, const QMetaObject& qMetaObject, QOrm::MergeMode mode);
     bool doRemove(QObject* entityInstance, const QMetaObject& qMetaObject);
 
     QOrmQueryBuilder<QObject> queryBuilderFor(const QMetaObject& relationMetaObject);
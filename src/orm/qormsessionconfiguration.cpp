@@ -38,16 +38,21 @@ class QOrmSessionConfigurationData : public QSharedData
 {
     friend class QOrmSessionConfiguration;
 
-    QOrmSessionConfigurationData(QOrmAbstractProvider* provider, bool isVerbose);
+    QOrmSessionConfigurationData(QOrmAbstractProvider* provider,
+                                 bool isVerbose,
+                                 int entityInstanceCacheSize);
 
     std::unique_ptr<QOrmAbstractProvider> m_provider;
     bool m_isVerbose{false};
+    int m_entityInstanceCacheSize{0};
 };
 
 QOrmSessionConfigurationData::QOrmSessionConfigurationData(QOrmAbstractProvider* provider,
-                                                           bool isVerbose)
+                                                           bool isVerbose,
+                                                           int entityInstanceCacheSize)
     : m_provider{provider}
     , m_isVerbose{isVerbose}
+    , m_entityInstanceCacheSize{entityInstanceCacheSize}
 {
     Q_ASSERT(provider != nullptr);
 }
@@ -57,7 +62,11 @@ static QOrmSqliteConfiguration _build_json_sqlite_configuration(const QJsonObjec
     QOrmSqliteConfiguration sqlConfiguration;
 
     sqlConfiguration.setDatabaseName(object["databaseName"].toString());
+    sqlConfiguration.setConnectionName(object["connectionName"].toString());
     sqlConfiguration.setVerbose(object["verbose"].toBool(false));
+    sqlConfiguration.setDetectExternalChanges(object["detectExternalChanges"].toBool(false));
+    sqlConfiguration.setUseSqlite3Api(object["useSqlite3Api"].toBool(false));
+    sqlConfiguration.setSlowQueryThreshold(object["slowQueryThreshold"].toInt(-1));
 
     QString schemaModeStr = object["schemaMode"].toString("validate");
 
@@ -126,6 +135,7 @@ QOrmSessionConfiguration QOrmSessionConfiguration::fromFile(const QString& fileP
 
             std::unique_ptr<QOrmAbstractProvider> provider;
             bool isVerbose = rootObject["verbose"].toBool(false);
+            int entityInstanceCacheSize = rootObject["entityInstanceCacheSize"].toInt(0);
 
             if (rootObject["provider"].toString().compare("sqlite") == 0)
             {
@@ -134,15 +144,19 @@ QOrmSessionConfiguration QOrmSessionConfiguration::fromFile(const QString& fileP
                 provider = std::make_unique<QOrmSqliteProvider>(sqlConfiguration);
             }
 
-            return QOrmSessionConfiguration{provider.release(), isVerbose};
+            return QOrmSessionConfiguration{provider.release(),
+                                            isVerbose,
+                                            entityInstanceCacheSize};
         }
     }
 
     qFatal("qtorm: Unable to open session configuration file %s", qPrintable(filePath));
 }
 
-QOrmSessionConfiguration::QOrmSessionConfiguration(QOrmAbstractProvider* provider, bool isVerbose)
-    : d{new QOrmSessionConfigurationData{provider, isVerbose}}
+QOrmSessionConfiguration::QOrmSessionConfiguration(QOrmAbstractProvider* provider,
+                                                   bool isVerbose,
+                                                   int entityInstanceCacheSize)
+    : d{new QOrmSessionConfigurationData{provider, isVerbose, entityInstanceCacheSize}}
 {
 }
 
@@ -167,4 +181,9 @@ bool QOrmSessionConfiguration::isVerbose() const
     return d->m_isVerbose;
 }
 
+int QOrmSessionConfiguration::entityInstanceCacheSize() const
+{
+    return d->m_entityInstanceCacheSize;
+}
+
 QT_END_NAMESPACE
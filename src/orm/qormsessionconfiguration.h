@@ -40,7 +40,9 @@ public:
     static QOrmSessionConfiguration fromFile(const QString& filePath);
 
 public:
-    QOrmSessionConfiguration(QOrmAbstractProvider* provider, bool isVerbose);
+    QOrmSessionConfiguration(QOrmAbstractProvider* provider,
+                             bool isVerbose,
+                             int entityInstanceCacheSize = 0);
     QOrmSessionConfiguration(const QOrmSessionConfiguration&);
     QOrmSessionConfiguration(QOrmSessionConfiguration&&);
     ~QOrmSessionConfiguration();
@@ -54,6 +56,12 @@ public:
     Q_REQUIRED_RESULT
     bool isVerbose() const;
 
+    // Maximum number of entity instances kept by the session, unlimited if 0. Evicted instances
+    // are deleted: pointers returned by earlier queries dangle unless the instances are pinned in
+    // the entity instance cache or have a parent object.
+    Q_REQUIRED_RESULT
+    int entityInstanceCacheSize() const;
+
 private:
     QSharedDataPointer<QOrmSessionConfigurationData> d;
 };
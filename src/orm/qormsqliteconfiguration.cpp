@@ -42,6 +42,16 @@ void QOrmSqliteConfiguration::setDatabaseName(const QString& databaseName)
     m_databaseName = databaseName;
 }
 
+QString QOrmSqliteConfiguration::connectionName() const
+{
+    return m_connectionName;
+}
+
+void QOrmSqliteConfiguration::setConnectionName(const QString& connectionName)
+{
+    m_connectionName = connectionName;
+}
+
 bool QOrmSqliteConfiguration::verbose() const
 {
     return m_verbose;
@@ -62,4 +72,34 @@ void QOrmSqliteConfiguration::setSchemaMode(SchemaMode schemaMode)
     m_schemaMode = schemaMode;
 }
 
+bool QOrmSqliteConfiguration::detectExternalChanges() const
+{
+    return m_detectExternalChanges;
+}
+
+void QOrmSqliteConfiguration::setDetectExternalChanges(bool detectExternalChanges)
+{
+    m_detectExternalChanges = detectExternalChanges;
+}
+
+bool QOrmSqliteConfiguration::useSqlite3Api() const
+{
+    return m_useSqlite3Api;
+}
+
+void QOrmSqliteConfiguration::setUseSqlite3Api(bool useSqlite3Api)
+{
+    m_useSqlite3Api = useSqlite3Api;
+}
+
+int QOrmSqliteConfiguration::slowQueryThreshold() const
+{
+    return m_slowQueryThreshold;
+}
+
+void QOrmSqliteConfiguration::setSlowQueryThreshold(int slowQueryThreshold)
+{
+    m_slowQueryThreshold = slowQueryThreshold;
+}
+
 QT_END_NAMESPACE
@@ -46,6 +46,11 @@ public:
     QString databaseName() const;
     void setDatabaseName(const QString& databaseName);
 
+    // Name of the QSqlDatabase connection, the default connection if empty
+    Q_REQUIRED_RESULT
+    QString connectionName() const;
+    void setConnectionName(const QString& connectionName);
+
     Q_REQUIRED_RESULT
     bool verbose() const;
     void setVerbose(bool verbose);
@@ -54,11 +59,32 @@ public:
     SchemaMode schemaMode() const;
     void setSchemaMode(SchemaMode schemaMode);
 
+    // Refresh cached instances changed by other connections or by triggers
+    Q_REQUIRED_RESULT
+    bool detectExternalChanges() const;
+    void setDetectExternalChanges(bool detectExternalChanges);
+
+    // Execute entity queries directly with the SQLite C API instead of QtSql. Requires QtOrm to
+    // be built with QTORM_USE_SQLITE3_API.
+    Q_REQUIRED_RESULT
+    bool useSqlite3Api() const;
+    void setUseSqlite3Api(bool useSqlite3Api);
+
+    // Entity queries taking at least this many milliseconds are logged with their query plan,
+    // disabled if negative
+    Q_REQUIRED_RESULT
+    int slowQueryThreshold() const;
+    void setSlowQueryThreshold(int slowQueryThreshold);
+
 private:
     QString m_connectOptions;
     QString m_databaseName;
+    QString m_connectionName;
     bool m_verbose{false};
     SchemaMode m_schemaMode;
+    bool m_detectExternalChanges{false};
+    bool m_useSqlite3Api{false};
+    int m_slowQueryThreshold{-1};
 };
 
 QT_END_NAMESPACE
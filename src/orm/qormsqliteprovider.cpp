@@ -33,11 +33,14 @@
 #include "qormqueryresult.h"
 #include "qormrelation.h"
 #include "qormsqliteconfiguration.h"
+#include "qormstatistics.h"
 
 #include "qormglobal_p.h"
 #include "qormsqlitestatementgenerator_p.h"
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QObject>
@@ -45,9 +48,127 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
+#include <QVersionNumber>
+
+#include <memory>
+
+#ifdef QTORM_USE_SQLITE3_API
+#include <QSqlDriver>
+
+#include <sqlite3.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
+// The result of a statement, read either through QSqlQuery or directly through the SQLite C API
+class QOrmSqliteCursor
+{
+public:
+    virtual ~QOrmSqliteCursor() = default;
+
+    Q_REQUIRED_RESULT
+    virtual QOrmError error() const = 0;
+    virtual bool next() = 0;
+    // releases the result so that a reused statement can be executed again
+    virtual void finish() = 0;
+
+    Q_REQUIRED_RESULT
+    virtual QVariant value(int column) const = 0;
+    // value of the field of the mapping in the current row, invalid if the field is NULL
+    Q_REQUIRED_RESULT
+    virtual QVariant value(const QOrmPropertyMapping& mapping) const = 0;
+
+    Q_REQUIRED_RESULT
+    virtual int numRowsAffected() const = 0;
+    Q_REQUIRED_RESULT
+    virtual QVariant lastInsertId() const = 0;
+};
+
+class QOrmSqlQueryCursor : public QOrmSqliteCursor
+{
+public:
+    explicit QOrmSqlQueryCursor(const QSqlQuery& query)
+        : m_query{query}
+        , m_record{query.isSelect() ? query.record() : QSqlRecord{}}
+    {
+    }
+
+    QOrmError error() const override
+    {
+        if (m_query.lastError().type() != QSqlError::NoError)
+            return QOrmError{QOrm::ErrorType::Provider, m_query.lastError().text()};
+
+        return QOrmError{QOrm::ErrorType::None, {}};
+    }
+
+    bool next() override { return m_query.next(); }
+    void finish() override { m_query.finish(); }
+
+    QVariant value(int column) const override { return m_query.value(column); }
+
+    QVariant value(const QOrmPropertyMapping& mapping) const override
+    {
+        // the record of the statement is built once rather than for every row
+        int column = m_record.indexOf(mapping.tableFieldName());
+
+        return m_query.isNull(column) ? QVariant{} : m_query.value(column);
+    }
+
+    int numRowsAffected() const override { return m_query.numRowsAffected(); }
+    QVariant lastInsertId() const override { return m_query.lastInsertId(); }
+
+private:
+    QSqlQuery m_query;
+    QSqlRecord m_record;
+};
+
+#ifdef QTORM_USE_SQLITE3_API
+// A statement executed on the sqlite3 handle of the Qt SQLite driver. Parameters are bound and
+// values are read according to their types without going through QSqlQuery and QSqlRecord.
+class QOrmSqliteStatementCursor : public QOrmSqliteCursor
+{
+    Q_DISABLE_COPY(QOrmSqliteStatementCursor)
+
+public:
+    QOrmSqliteStatementCursor(sqlite3* handle, const QString& statement, bool isPersistent);
+    ~QOrmSqliteStatementCursor() override;
+
+    bool exec(const QVariantMap& parameters);
+
+    QOrmError error() const override { return m_error; }
+    bool next() override;
+    void finish() override;
+
+    QVariant value(int column) const override;
+    QVariant value(const QOrmPropertyMapping& mapping) const override;
+
+    int numRowsAffected() const override { return m_rowsAffected; }
+    QVariant lastInsertId() const override { return m_lastInsertId; }
+
+private:
+    bool step();
+    int bindValue(int index, const QVariant& value);
+    int bindText(int index, const QString& text);
+    Q_REQUIRED_RESULT
+    int columnIndex(const QString& fieldName) const;
+    Q_REQUIRED_RESULT
+    QString text(int column) const;
+    Q_REQUIRED_RESULT
+    QByteArray blob(int column) const;
+    void setError();
+
+    sqlite3* m_handle{nullptr};
+    sqlite3_stmt* m_statement{nullptr};
+    QHash<QString, int> m_columns;
+    QOrmError m_error{QOrm::ErrorType::None, {}};
+    // exec() steps to the first row, next() positions the cursor on it
+    bool m_hasPendingRow{false};
+    bool m_isOnRow{false};
+    int m_rowsAffected{0};
+    QVariant m_lastInsertId;
+};
+#endif
+
 class QOrmSqliteProviderPrivate
 {
     friend class QOrmSqliteProvider;
@@ -60,6 +181,31 @@ class QOrmSqliteProviderPrivate
     QSqlDatabase m_database;
     QOrmSqliteConfiguration m_sqlConfiguration;
     QSet<QString> m_schemaSyncCache;
+    // prepared write statements by statement text
+    QHash<QString, QSqlQuery> m_preparedStatements;
+    QVersionNumber m_sqliteVersion;
+#ifdef QTORM_USE_SQLITE3_API
+    // handle used to execute the statements directly, null if they are executed by QtSql
+    sqlite3* m_sqliteApiHandle{nullptr};
+    // reused write statements, finalized before the connection is closed
+    QHash<QString, std::shared_ptr<QOrmSqliteStatementCursor>> m_sqliteApiStatements;
+#endif
+    // entities by lower-case table name, to find the instances of the rows changed by others
+    QHash<QString, QOrmMetadata> m_entitiesByTable;
+    // table written by the statement in progress, the session knows about its changes
+    QString m_writtenTable;
+    // rows changed through this connection by statements not issued by the provider, e.g. by
+    // triggers or cascades
+    QHash<QString, QSet<qint64>> m_changedRows;
+    QSet<QString> m_changedTables;
+    // incremented by SQLite whenever another connection commits
+    qint64 m_dataVersion{-1};
+    QOrmStatistics m_statistics;
+    QOrmStatistics::StatementObserver m_statementObserver;
+    // statements whose query plan has been logged
+    QSet<QString> m_explainedStatements;
+
+    static constexpr int MaximumChangedRows = 1024;
 
     Q_REQUIRED_RESULT
     QString toSqlType(QVariant::Type type);
@@ -68,16 +214,42 @@ class QOrmSqliteProviderPrivate
     QOrmError lastDatabaseError() const;
 
     Q_REQUIRED_RESULT
-    QSqlQuery prepareAndExecute(const QString& statement, const QVariantMap& parameters);
+    QString connectionName() const
+    {
+        return m_sqlConfiguration.connectionName().isEmpty()
+                   ? QString::fromLatin1(QSqlDatabase::defaultConnection)
+                   : m_sqlConfiguration.connectionName();
+    }
+
+    void recordStatement(const QString& statement,
+                         qint64 prepareNanoseconds,
+                         qint64 executeNanoseconds,
+                         bool isSuccessful);
+    // Logs the statement if it has taken longer than the slow query threshold. The time of a
+    // read includes preparing, executing and stepping the statement, but not the hydration of
+    // the instances, which may read referenced entities.
+    void logSlowQuery(const QString& statement,
+                      const QVariantMap& parameters,
+                      qint64 rows,
+                      qint64 elapsedNanoseconds);
+
+    QSqlQuery prepareAndExecute(const QString& statement,
+                                const QVariantMap& parameters = {},
+                                bool reusePreparedStatement = false);
+    // executes the statements of entity queries, through the SQLite C API if enabled
+    Q_REQUIRED_RESULT
+    std::shared_ptr<QOrmSqliteCursor> executeStatement(const QString& statement,
+                                                       const QVariantMap& parameters,
+                                                       bool reusePreparedStatement = false);
 
     Q_REQUIRED_RESULT
     QOrmPrivate::Expected<QObject*, QOrmError> makeEntityInstance(
         const QOrmMetadata& entityMetadata,
-        const QSqlRecord& record,
+        const QOrmSqliteCursor& cursor,
         QOrmEntityInstanceCache& entityInstanceCache);
     QOrmError fillEntityInstance(const QOrmMetadata& entityMetadata,
                                  QObject* entityInstance,
-                                 const QSqlRecord& record,
+                                 const QOrmSqliteCursor& cursor,
                                  QOrmEntityInstanceCache& entityInstanceCache,
                                  const QFlags<QOrm::QueryFlags>& queryFlags);
 
@@ -88,25 +260,355 @@ class QOrmSqliteProviderPrivate
 
     QOrmQueryResult<QObject> read(const QOrmQuery& query,
                                   QOrmEntityInstanceCache& entityInstanceCache);
+    QOrmQueryResult<QObject> count(const QOrmQuery& query);
+    QOrmError readValues(const QOrmQuery& query,
+                         const QOrmAbstractProvider::ValueRowHandler& handler);
     QOrmQueryResult<QObject> merge(const QOrmQuery& query);
+    QOrmQueryResult<QObject> upsert(const QOrmQuery& query);
     QOrmQueryResult<QObject> remove(const QOrmQuery& query);
+
+    void registerEntity(const QOrmMetadata& entity);
+    void recordChange(const QString& tableName, qint64 rowId);
+    void detectExternalChanges(QOrmEntityInstanceCache& entityInstanceCache);
+
+#ifdef QTORM_USE_SQLITE3_API
+    Q_REQUIRED_RESULT
+    sqlite3* sqliteHandle() const;
+    static void onSqliteUpdate(void* context,
+                               int operation,
+                               const char* databaseName,
+                               const char* tableName,
+                               sqlite3_int64 rowId);
+#endif
+};
+
+// The rows of the table written by the provider are changed on behalf of the session
+class QOrmSqliteWriteScope
+{
+public:
+    QOrmSqliteWriteScope(QString& writtenTable, const QOrmQuery& query)
+        : m_writtenTable{writtenTable}
+    {
+        Q_ASSERT(query.relation().type() == QOrm::RelationType::Mapping);
+        m_writtenTable = query.relation().mapping()->tableName().toLower();
+    }
+
+    ~QOrmSqliteWriteScope() { m_writtenTable.clear(); }
+
+private:
+    QString& m_writtenTable;
 };
 
+#ifdef QTORM_USE_SQLITE3_API
+QOrmSqliteStatementCursor::QOrmSqliteStatementCursor(sqlite3* handle,
+                                                     const QString& statement,
+                                                     bool isPersistent)
+    : m_handle{handle}
+{
+    QByteArray utf8 = statement.toUtf8();
+
+    if (sqlite3_prepare_v3(m_handle,
+                           utf8.constData(),
+                           utf8.size(),
+                           isPersistent ? SQLITE_PREPARE_PERSISTENT : 0,
+                           &m_statement,
+                           nullptr) != SQLITE_OK)
+    {
+        setError();
+        return;
+    }
+
+    int columnCount = sqlite3_column_count(m_statement);
+
+    for (int column = 0; column < columnCount; ++column)
+        m_columns.insert(QString::fromUtf8(sqlite3_column_name(m_statement, column)), column);
+}
+
+QOrmSqliteStatementCursor::~QOrmSqliteStatementCursor()
+{
+    sqlite3_finalize(m_statement);
+}
+
+bool QOrmSqliteStatementCursor::exec(const QVariantMap& parameters)
+{
+    // the error of the preparation is kept
+    if (m_statement == nullptr)
+        return false;
+
+    sqlite3_reset(m_statement);
+    sqlite3_clear_bindings(m_statement);
+
+    m_error = QOrmError{QOrm::ErrorType::None, {}};
+    m_hasPendingRow = false;
+    m_isOnRow = false;
+
+    for (auto it = parameters.begin(); it != parameters.end(); ++it)
+    {
+        int index = sqlite3_bind_parameter_index(m_statement, it.key().toUtf8().constData());
+
+        if (index == 0)
+        {
+            m_error = QOrmError{QOrm::ErrorType::Provider,
+                                QStringLiteral("Unknown parameter %1").arg(it.key())};
+            return false;
+        }
+
+        if (bindValue(index, it.value()) != SQLITE_OK)
+        {
+            setError();
+            return false;
+        }
+    }
+
+    m_hasPendingRow = step();
+
+    if (m_error != QOrm::ErrorType::None)
+        return false;
+
+    m_rowsAffected = sqlite3_changes(m_handle);
+
+    sqlite3_int64 lastInsertId = sqlite3_last_insert_rowid(m_handle);
+    m_lastInsertId =
+        lastInsertId != 0 ? QVariant{static_cast<qlonglong>(lastInsertId)} : QVariant{};
+
+    return true;
+}
+
+bool QOrmSqliteStatementCursor::next()
+{
+    if (m_hasPendingRow)
+    {
+        m_hasPendingRow = false;
+        m_isOnRow = true;
+    }
+    else if (m_isOnRow)
+    {
+        m_isOnRow = step();
+    }
+
+    return m_isOnRow;
+}
+
+void QOrmSqliteStatementCursor::finish()
+{
+    m_hasPendingRow = false;
+    m_isOnRow = false;
+
+    if (m_statement != nullptr)
+        sqlite3_reset(m_statement);
+}
+
+QVariant QOrmSqliteStatementCursor::value(int column) const
+{
+    // the same types as returned by the Qt SQLite driver
+    switch (sqlite3_column_type(m_statement, column))
+    {
+        case SQLITE_INTEGER:
+            return QVariant{static_cast<qlonglong>(sqlite3_column_int64(m_statement, column))};
+
+        case SQLITE_FLOAT:
+            return QVariant{sqlite3_column_double(m_statement, column)};
+
+        case SQLITE_BLOB:
+            return QVariant{blob(column)};
+
+        case SQLITE_NULL:
+            return QVariant{};
+
+        default:
+            return QVariant{text(column)};
+    }
+}
+
+QVariant QOrmSqliteStatementCursor::value(const QOrmPropertyMapping& mapping) const
+{
+    int column = columnIndex(mapping.tableFieldName());
+
+    if (column < 0 || sqlite3_column_type(m_statement, column) == SQLITE_NULL)
+        return QVariant{};
+
+    // a reference is stored as the object ID of the referenced instance
+    QVariant::Type dataType = mapping.dataType();
+
+    if (mapping.isReference() && mapping.referencedEntity()->objectIdMapping() != nullptr)
+        dataType = mapping.referencedEntity()->objectIdMapping()->dataType();
+
+    switch (dataType)
+    {
+        case QVariant::Bool:
+            return QVariant{sqlite3_column_int64(m_statement, column) != 0};
+
+        case QVariant::Int:
+            return QVariant{sqlite3_column_int(m_statement, column)};
+
+        case QVariant::UInt:
+            return QVariant{static_cast<uint>(sqlite3_column_int64(m_statement, column))};
+
+        case QVariant::LongLong:
+            return QVariant{static_cast<qlonglong>(sqlite3_column_int64(m_statement, column))};
+
+        case QVariant::ULongLong:
+            return QVariant{static_cast<qulonglong>(sqlite3_column_int64(m_statement, column))};
+
+        case QVariant::Double:
+            return QVariant{sqlite3_column_double(m_statement, column)};
+
+        case QVariant::String:
+            return QVariant{text(column)};
+
+        case QVariant::ByteArray:
+            return QVariant{blob(column)};
+
+        // dates, times and other types are converted when the property is set
+        default:
+            return value(column);
+    }
+}
+
+bool QOrmSqliteStatementCursor::step()
+{
+    int result = sqlite3_step(m_statement);
+
+    if (result == SQLITE_ROW)
+        return true;
+
+    if (result != SQLITE_DONE)
+        setError();
+
+    return false;
+}
+
+int QOrmSqliteStatementCursor::bindValue(int index, const QVariant& value)
+{
+    if (value.isNull())
+        return sqlite3_bind_null(m_statement, index);
+
+    // the same representation as written by the Qt SQLite driver
+    switch (value.userType())
+    {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+            return sqlite3_bind_int64(m_statement, index, value.toLongLong());
+
+        case QMetaType::ULongLong:
+            return sqlite3_bind_int64(m_statement,
+                                      index,
+                                      static_cast<sqlite3_int64>(value.toULongLong()));
+
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return sqlite3_bind_double(m_statement, index, value.toDouble());
+
+        case QMetaType::QByteArray:
+        {
+            QByteArray data = value.toByteArray();
+            return sqlite3_bind_blob(
+                m_statement, index, data.constData(), data.size(), SQLITE_TRANSIENT);
+        }
+
+        case QMetaType::QDateTime:
+            return bindText(index, value.toDateTime().toString(Qt::ISODateWithMs));
+
+        case QMetaType::QTime:
+            return bindText(index, value.toTime().toString(QStringLiteral("hh:mm:ss.zzz")));
+
+        default:
+            return bindText(index, value.toString());
+    }
+}
+
+int QOrmSqliteStatementCursor::bindText(int index, const QString& text)
+{
+    return sqlite3_bind_text16(m_statement,
+                               index,
+                               text.utf16(),
+                               text.size() * static_cast<int>(sizeof(ushort)),
+                               SQLITE_TRANSIENT);
+}
+
+int QOrmSqliteStatementCursor::columnIndex(const QString& fieldName) const
+{
+    auto it = m_columns.find(fieldName);
+
+    if (it != std::end(m_columns))
+        return *it;
+
+    // field names are case insensitive
+    for (it = m_columns.begin(); it != std::end(m_columns); ++it)
+    {
+        if (it.key().compare(fieldName, Qt::CaseInsensitive) == 0)
+            return *it;
+    }
+
+    return -1;
+}
+
+QString QOrmSqliteStatementCursor::text(int column) const
+{
+    // the length must be retrieved after the conversion to UTF-16
+    const void* data = sqlite3_column_text16(m_statement, column);
+    int size = sqlite3_column_bytes16(m_statement, column) / static_cast<int>(sizeof(QChar));
+
+    return QString{static_cast<const QChar*>(data), size};
+}
+
+QByteArray QOrmSqliteStatementCursor::blob(int column) const
+{
+    const void* data = sqlite3_column_blob(m_statement, column);
+    int size = sqlite3_column_bytes(m_statement, column);
+
+    return QByteArray{static_cast<const char*>(data), size};
+}
+
+void QOrmSqliteStatementCursor::setError()
+{
+    m_error = QOrmError{QOrm::ErrorType::Provider, QString::fromUtf8(sqlite3_errmsg(m_handle))};
+}
+#endif
+
 QOrmError QOrmSqliteProviderPrivate::lastDatabaseError() const
 {
     return QOrmError{QOrm::ErrorType::Provider, m_database.lastError().text()};
 }
 
 QSqlQuery QOrmSqliteProviderPrivate::prepareAndExecute(const QString& statement,
-                                                    const QVariantMap& parameters = {})
+                                                    const QVariantMap& parameters,
+                                                    bool reusePreparedStatement)
 {
     QSqlQuery query{m_database};
 
     if (m_sqlConfiguration.verbose())
         qCDebug(qtorm) << "Executing:" << statement;
 
-    if (!query.prepare(statement))
-        return query;
+    // Statements that are executed repeatedly with different parameters, like the inserts and
+    // updates of a flush, are prepared only once. Reads are not reused because they can be
+    // nested while a query with the same statement is still being iterated.
+    auto it = reusePreparedStatement ? m_preparedStatements.find(statement)
+                                     : std::end(m_preparedStatements);
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 prepareNanoseconds = 0;
+
+    if (it != std::end(m_preparedStatements))
+    {
+        query = *it;
+    }
+    else
+    {
+        if (!query.prepare(statement))
+        {
+            recordStatement(statement, timer.nsecsElapsed(), 0, false);
+            return query;
+        }
+
+        prepareNanoseconds = timer.restart();
+
+        if (reusePreparedStatement)
+            m_preparedStatements.insert(statement, query);
+    }
 
     if (!parameters.isEmpty())
     {
@@ -117,25 +619,130 @@ QSqlQuery QOrmSqliteProviderPrivate::prepareAndExecute(const QString& statement,
             query.bindValue(it.key(), it.value());
     }
 
-    query.exec();
+    bool isSuccessful = query.exec();
+    recordStatement(statement, prepareNanoseconds, timer.nsecsElapsed(), isSuccessful);
 
     return query;
 }
 
+void QOrmSqliteProviderPrivate::recordStatement(const QString& statement,
+                                                qint64 prepareNanoseconds,
+                                                qint64 executeNanoseconds,
+                                                bool isSuccessful)
+{
+    QOrmStatementEvent event{statement, prepareNanoseconds, executeNanoseconds, isSuccessful};
+
+    m_statistics.recordStatement(event);
+
+    if (m_statementObserver)
+        m_statementObserver(event);
+}
+
+void QOrmSqliteProviderPrivate::logSlowQuery(const QString& statement,
+                                             const QVariantMap& parameters,
+                                             qint64 rows,
+                                             qint64 elapsedNanoseconds)
+{
+    int threshold = m_sqlConfiguration.slowQueryThreshold();
+    qint64 elapsed = elapsedNanoseconds / 1000000;
+
+    if (threshold < 0 || elapsed < threshold)
+        return;
+
+    qCWarning(qtorm).noquote() << QStringLiteral("Slow query (%1 ms, %2 rows): %3")
+                                      .arg(elapsed)
+                                      .arg(rows)
+                                      .arg(statement);
+
+    if (!parameters.isEmpty())
+        qCWarning(qtorm) << "Bound parameters:" << parameters;
+
+    // the plan depends on the statement only, it is logged once
+    if (m_explainedStatements.contains(statement))
+        return;
+
+    m_explainedStatements.insert(statement);
+
+    // executed directly to keep it out of the statistics
+    QSqlQuery query{m_database};
+
+    if (query.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + statement))
+    {
+        for (auto it = parameters.begin(); it != parameters.end(); ++it)
+            query.bindValue(it.key(), it.value());
+
+        if (query.exec())
+        {
+            // the last column describes the step
+            while (query.next())
+                qCWarning(qtorm).noquote() << "Query plan:" << query.value(3).toString();
+
+            return;
+        }
+    }
+
+    qCWarning(qtorm) << "Unable to explain the query plan:" << query.lastError().text();
+}
+
+std::shared_ptr<QOrmSqliteCursor> QOrmSqliteProviderPrivate::executeStatement(
+    const QString& statement,
+    const QVariantMap& parameters,
+    bool reusePreparedStatement)
+{
+#ifdef QTORM_USE_SQLITE3_API
+    if (m_sqliteApiHandle != nullptr)
+    {
+        if (m_sqlConfiguration.verbose())
+        {
+            qCDebug(qtorm) << "Executing:" << statement;
+
+            if (!parameters.isEmpty())
+                qCDebug(qtorm) << "Bound parameters:" << parameters;
+        }
+
+        std::shared_ptr<QOrmSqliteStatementCursor> cursor;
+
+        if (reusePreparedStatement)
+            cursor = m_sqliteApiStatements.value(statement);
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 prepareNanoseconds = 0;
+
+        if (cursor == nullptr)
+        {
+            cursor = std::make_shared<QOrmSqliteStatementCursor>(
+                m_sqliteApiHandle, statement, reusePreparedStatement);
+            prepareNanoseconds = timer.restart();
+
+            if (reusePreparedStatement && cursor->error() == QOrm::ErrorType::None)
+                m_sqliteApiStatements.insert(statement, cursor);
+        }
+
+        bool isSuccessful = cursor->exec(parameters);
+        recordStatement(statement, prepareNanoseconds, timer.nsecsElapsed(), isSuccessful);
+
+        return cursor;
+    }
+#endif
+
+    return std::make_shared<QOrmSqlQueryCursor>(
+        prepareAndExecute(statement, parameters, reusePreparedStatement));
+}
+
 QOrmPrivate::Expected<QObject*, QOrmError> QOrmSqliteProviderPrivate::makeEntityInstance(
     const QOrmMetadata& entityMetadata,
-    const QSqlRecord& record,
+    const QOrmSqliteCursor& cursor,
     QOrmEntityInstanceCache& entityInstanceCache)
 {
-    QObject* entityInstance = entityMetadata.qMetaObject().newInstance();
+    QObject* entityInstance = entityMetadata.newInstance();
     Q_ASSERT(entityInstance != nullptr);
 
     // assign object ID and put into cache to be able to resolve cyclic references
     Q_ASSERT(entityMetadata.objectIdMapping() != nullptr);
     if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                       entityMetadata.objectIdMapping()->classPropertyName(),
-                                       record.value(
-                                           entityMetadata.objectIdMapping()->tableFieldName())))
+                                       *entityMetadata.objectIdMapping(),
+                                       cursor.value(*entityMetadata.objectIdMapping())))
     {
         Q_ORM_UNEXPECTED_STATE;
     }
@@ -144,7 +751,7 @@ QOrmPrivate::Expected<QObject*, QOrmError> QOrmSqliteProviderPrivate::makeEntity
 
     // fill the rest of the properties
     QOrmError fillError = fillEntityInstance(
-        entityMetadata, entityInstance, record, entityInstanceCache, QOrm::QueryFlags::None);
+        entityMetadata, entityInstance, cursor, entityInstanceCache, QOrm::QueryFlags::None);
 
     if (fillError != QOrm::ErrorType::None)
         return QOrmPrivate::makeUnexpected(fillError);
@@ -157,7 +764,7 @@ QOrmPrivate::Expected<QObject*, QOrmError> QOrmSqliteProviderPrivate::makeEntity
 QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
     const QOrmMetadata& entityMetadata,
     QObject* entityInstance,
-    const QSqlRecord& record,
+    const QOrmSqliteCursor& cursor,
     QOrmEntityInstanceCache& entityInstanceCache,
     const QFlags<QOrm::QueryFlags>& queryFlags)
 {
@@ -211,9 +818,7 @@ QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
                     Q_ORM_UNEXPECTED_STATE;
 
                 Q_ASSERT(propertyValue.isValid() && !propertyValue.isNull());
-                if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                                   mapping.classPropertyName(),
-                                                   propertyValue))
+                if (!QOrmPrivate::setPropertyValue(entityInstance, mapping, propertyValue))
                 {
                     Q_ORM_UNEXPECTED_STATE;
                 }
@@ -224,7 +829,7 @@ QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
                 Q_ASSERT(mapping.referencedEntity() != nullptr);
 
                 // try to retrieve the referenced instance from the cache.
-                QVariant referencedObjectId = record.value(mapping.tableFieldName());
+                QVariant referencedObjectId = cursor.value(mapping);
 
                 if (referencedObjectId.isNull())
                     continue;
@@ -242,10 +847,8 @@ QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
                         Q_ORM_UNEXPECTED_STATE;
                     }
 
-                    if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                                       mapping.classPropertyName(),
-                                                       QVariant::fromValue(
-                                                           referencedEntityInstance)))
+                    if (!QOrmPrivate::setPropertyValue(
+                            entityInstance, mapping, QVariant::fromValue(referencedEntityInstance)))
                     {
                         Q_ORM_UNEXPECTED_STATE;
                     }
@@ -276,7 +879,7 @@ QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
                     Q_ASSERT(result.toVector().size() == 1);
 
                     if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                                       mapping.classPropertyName(),
+                                                       mapping,
                                                        QVariant::fromValue(
                                                            result.toVector().front())))
                     {
@@ -288,12 +891,7 @@ QOrmError QOrmSqliteProviderPrivate::fillEntityInstance(
         // just a value: set the property value
         else
         {
-            bool isNull = record.isNull(mapping.tableFieldName());
-
-            if (!QOrmPrivate::setPropertyValue(entityInstance,
-                                               mapping.classPropertyName(),
-                                               isNull ? QVariant{}
-                                                      : record.value(mapping.tableFieldName())))
+            if (!QOrmPrivate::setPropertyValue(entityInstance, mapping, cursor.value(mapping)))
             {
                 qCDebug(qtorm,
                         "Unable to setPropertyValue() for %s <-> %s",
@@ -323,6 +921,9 @@ QOrmError QOrmSqliteProviderPrivate::ensureSchemaSynchronized(const QOrmRelation
 
             std::optional<QOrmError> error;
 
+            QElapsedTimer timer;
+            timer.start();
+
             switch (m_sqlConfiguration.schemaMode())
             {
                 case QOrmSqliteConfiguration::SchemaMode::Recreate:
@@ -343,6 +944,8 @@ QOrmError QOrmSqliteProviderPrivate::ensureSchemaSynchronized(const QOrmRelation
 
             Q_ASSERT(error.has_value());
 
+            m_statistics.recordSchemaSynchronization(timer.nsecsElapsed());
+
             if (error->type() == QOrm::ErrorType::None)
             {
                 m_schemaSyncCache.insert(relation.mapping()->className());
@@ -464,13 +1067,33 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
 {
     Q_ASSERT(query.projection().has_value());
 
+    registerEntity(*query.projection());
+
     auto [statement, boundParameters] = QOrmSqliteStatementGenerator::generate(query);
 
-    QSqlQuery sqlQuery = prepareAndExecute(statement, boundParameters);
+    QElapsedTimer timer;
+    timer.start();
 
-    if (sqlQuery.lastError().type() != QSqlError::NoError)
-        return QOrmQueryResult<QObject>{
-            QOrmError{QOrm::ErrorType::Provider, sqlQuery.lastError().text()}};
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters);
+
+    if (cursor->error() != QOrm::ErrorType::None)
+        return QOrmQueryResult<QObject>{cursor->error()};
+
+    // Hydration can read referenced entities with statements of their own, so the statement is
+    // timed by its steps only
+    qint64 statementNanoseconds = timer.nsecsElapsed();
+    qint64 stepNanoseconds = 0;
+
+    auto next = [&cursor, &timer, &stepNanoseconds]() {
+        timer.restart();
+        bool hasRow = cursor->next();
+        stepNanoseconds += timer.nsecsElapsed();
+
+        return hasRow;
+    };
+
+    QElapsedTimer hydrateTimer;
+    hydrateTimer.start();
 
     QVector<QObject*> resultSet;
 
@@ -481,9 +1104,9 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
     // All read entities are replaced with their cached versions if found.
     if (objectIdMapping != nullptr)
     {
-        while (sqlQuery.next())
+        while (next())
         {
-            QVariant objectId = sqlQuery.value(objectIdMapping->tableFieldName());
+            QVariant objectId = cursor->value(*objectIdMapping);
 
             QObject* cachedInstance = entityInstanceCache.get(*query.projection(), objectId);
 
@@ -504,19 +1127,22 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
                         return QOrmQueryResult<QObject>{
                             QOrmError{QOrm::ErrorType::UnsynchronizedEntity, errorString}};
                 }
-                else if (query.flags().testFlag(QOrm::QueryFlags::OverwriteCachedInstances))
+                // a stale instance without unsaved changes is refreshed from the database
+                else if (query.flags().testFlag(QOrm::QueryFlags::OverwriteCachedInstances) ||
+                         entityInstanceCache.isStale(cachedInstance))
                 {
                     QOrmError error = fillEntityInstance(*query.projection(),
                                                          cachedInstance,
-                                                         sqlQuery.record(),
+                                                         *cursor,
                                                          entityInstanceCache,
                                                          query.flags());
 
                     if (error != QOrm::ErrorType::None)
-                    {
-                        entityInstanceCache.markUnmodified(cachedInstance);
                         return QOrmQueryResult<QObject>{error};
-                    }
+
+                    // the instance matches the database again
+                    entityInstanceCache.markUnmodified(cachedInstance);
+                    entityInstanceCache.markUpToDate(cachedInstance);
                 }
 
                 resultSet.push_back(cachedInstance);
@@ -525,7 +1151,7 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
             else
             {
                 QOrmPrivate::Expected<QObject*, QOrmError> entityInstance =
-                    makeEntityInstance(*query.projection(), sqlQuery.record(), entityInstanceCache);
+                    makeEntityInstance(*query.projection(), *cursor, entityInstanceCache);
 
                 if (entityInstance)
                 {
@@ -537,14 +1163,18 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
                 }
             }
         }
+
+        // already cached instances remain in the cache
+        if (cursor->error() != QOrm::ErrorType::None)
+            return QOrmQueryResult<QObject>{cursor->error()};
     }
     // No object ID in this projection: cannot cache, just return the results
     else
     {
-        while (sqlQuery.next())
+        while (next())
         {
             QOrmPrivate::Expected<QObject*, QOrmError> entityInstance =
-                makeEntityInstance(*query.projection(), sqlQuery.record(), entityInstanceCache);
+                makeEntityInstance(*query.projection(), *cursor, entityInstanceCache);
 
             if (entityInstance)
             {
@@ -558,11 +1188,104 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::read(
                 return QOrmQueryResult<QObject>{entityInstance.error()};
             }
         }
+
+        if (cursor->error() != QOrm::ErrorType::None)
+        {
+            qDeleteAll(resultSet);
+            return QOrmQueryResult<QObject>{cursor->error()};
+        }
     }
 
+    m_statistics.recordHydration(hydrateTimer.nsecsElapsed() - stepNanoseconds);
+    m_statistics.recordRows(statement, resultSet.size(), 0);
+    logSlowQuery(statement,
+                 boundParameters,
+                 resultSet.size(),
+                 statementNanoseconds + stepNanoseconds);
+
     return QOrmQueryResult<QObject>{resultSet};
 }
 
+QOrmError QOrmSqliteProviderPrivate::readValues(
+    const QOrmQuery& query,
+    const QOrmAbstractProvider::ValueRowHandler& handler)
+{
+    Q_ASSERT(query.operation() == QOrm::Operation::Read);
+    Q_ASSERT(query.projection().has_value());
+
+    registerEntity(*query.projection());
+
+    auto [statement, boundParameters] = QOrmSqliteStatementGenerator::generate(query);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters);
+
+    if (cursor->error() != QOrm::ErrorType::None)
+        return cursor->error();
+
+    const std::vector<QOrmPropertyMapping>& mappings = query.projection()->propertyMappings();
+
+    // the row is reused to avoid allocations per row
+    QVector<QVariant> values(static_cast<int>(mappings.size()));
+    qint64 rowsRead = 0;
+
+    // the statement is timed without the row handler
+    qint64 statementNanoseconds = timer.nsecsElapsed();
+    qint64 stepNanoseconds = 0;
+
+    auto next = [&cursor, &timer, &stepNanoseconds]() {
+        timer.restart();
+        bool hasRow = cursor->next();
+        stepNanoseconds += timer.nsecsElapsed();
+
+        return hasRow;
+    };
+
+    QElapsedTimer hydrateTimer;
+    hydrateTimer.start();
+
+    while (next())
+    {
+        for (int i = 0; i < values.size(); ++i)
+        {
+            const QOrmPropertyMapping& mapping = mappings[static_cast<size_t>(i)];
+            values[i] = mapping.isTransient() ? QVariant{} : cursor->value(mapping);
+        }
+
+        handler(values);
+        ++rowsRead;
+    }
+
+    m_statistics.recordHydration(hydrateTimer.nsecsElapsed() - stepNanoseconds);
+    m_statistics.recordRows(statement, rowsRead, 0);
+    logSlowQuery(statement, boundParameters, rowsRead, statementNanoseconds + stepNanoseconds);
+
+    return cursor->error();
+}
+
+QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::count(const QOrmQuery& query)
+{
+    auto [statement, boundParameters] = QOrmSqliteStatementGenerator::generate(query);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters);
+
+    if (cursor->error() != QOrm::ErrorType::None)
+        return QOrmQueryResult<QObject>{cursor->error()};
+
+    if (!cursor->next())
+        Q_ORM_UNEXPECTED_STATE;
+
+    QVariant count = cursor->value(0);
+    logSlowQuery(statement, boundParameters, 1, timer.nsecsElapsed());
+
+    return QOrmQueryResult<QObject>{count};
+}
+
 QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::merge(const QOrmQuery& query)
 {
     Q_ASSERT(query.relation().type() == QOrm::RelationType::Mapping);
@@ -570,31 +1293,213 @@ QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::merge(const QOrmQuery& query
 
     auto [statement, boundParameters] = QOrmSqliteStatementGenerator::generate(query);
 
-    QSqlQuery sqlQuery = prepareAndExecute(statement, boundParameters);
+    QElapsedTimer timer;
+    timer.start();
+
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters, true);
 
-    if (sqlQuery.lastError().type() != QSqlError::NoError)
-        return QOrmQueryResult<QObject>{{QOrm::ErrorType::Provider, sqlQuery.lastError().text()}};
+    if (cursor->error() != QOrm::ErrorType::None)
+        return QOrmQueryResult<QObject>{cursor->error()};
 
-    if (sqlQuery.numRowsAffected() != 1)
+    m_statistics.recordRows(statement, 0, cursor->numRowsAffected());
+    logSlowQuery(statement, boundParameters, cursor->numRowsAffected(), timer.nsecsElapsed());
+
+    if (cursor->numRowsAffected() != 1)
     {
         return QOrmQueryResult<QObject>{
             {QOrm::ErrorType::UnsynchronizedEntity, "Unexpected number of rows affected"}};
     }
 
-    return QOrmQueryResult<QObject>{sqlQuery.lastInsertId()};
+    return QOrmQueryResult<QObject>{cursor->lastInsertId()};
+}
+
+QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::upsert(const QOrmQuery& query)
+{
+    Q_ASSERT(query.relation().type() == QOrm::RelationType::Mapping);
+    Q_ASSERT(query.entityInstance() != nullptr);
+
+    // UPSERT is available since SQLite 3.24, RETURNING since 3.35
+    if (m_sqliteVersion < QVersionNumber{3, 24})
+    {
+        return QOrmQueryResult<QObject>{
+            {QOrm::ErrorType::Provider,
+             QStringLiteral("Upsert requires SQLite 3.24 or later, the database is %1")
+                 .arg(m_sqliteVersion.toString())}};
+    }
+
+    bool hasReturning = m_sqliteVersion >= QVersionNumber{3, 35};
+
+    const QOrmMetadata& entity = *query.relation().mapping();
+    QVariantMap boundParameters;
+    QString statement = QOrmSqliteStatementGenerator::generateUpsertStatement(
+        entity, query.entityInstance(), boundParameters, hasReturning);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters, true);
+
+    if (cursor->error() != QOrm::ErrorType::None)
+        return QOrmQueryResult<QObject>{cursor->error()};
+
+    m_statistics.recordRows(statement, 0, 1);
+
+    // The object ID is returned even if the row was updated. Without RETURNING, the last insert
+    // ID is not changed by an update, so the bound object ID is used unless it was assigned by
+    // the database.
+    QVariant objectId = QOrmPrivate::objectIdPropertyValue(query.entityInstance(), entity);
+
+    if (hasReturning)
+    {
+        if (cursor->next())
+            objectId = cursor->value(0);
+
+        // release the statement so that it can be reused by the next upsert
+        cursor->finish();
+    }
+    else if (entity.objectIdMapping()->isAutogenerated() &&
+             (objectId.isNull() || objectId.toLongLong() == 0))
+    {
+        objectId = cursor->lastInsertId();
+    }
+
+    logSlowQuery(statement, boundParameters, 1, timer.nsecsElapsed());
+
+    return QOrmQueryResult<QObject>{objectId};
 }
 
 QOrmQueryResult<QObject> QOrmSqliteProviderPrivate::remove(const QOrmQuery& query)
 {
     auto [statement, boundParameters] = QOrmSqliteStatementGenerator::generate(query);
 
-    QSqlQuery sqlQuery = prepareAndExecute(statement, boundParameters);
+    QElapsedTimer timer;
+    timer.start();
+
+    std::shared_ptr<QOrmSqliteCursor> cursor = executeStatement(statement, boundParameters, true);
+
+    if (cursor->error() != QOrm::ErrorType::None)
+        return QOrmQueryResult<QObject>{cursor->error()};
+
+    m_statistics.recordRows(statement, 0, cursor->numRowsAffected());
+    logSlowQuery(statement, boundParameters, cursor->numRowsAffected(), timer.nsecsElapsed());
+
+    return QOrmQueryResult<QObject>{cursor->numRowsAffected()};
+}
+
+void QOrmSqliteProviderPrivate::registerEntity(const QOrmMetadata& entity)
+{
+    QString tableName = entity.tableName().toLower();
+
+    if (!m_entitiesByTable.contains(tableName))
+        m_entitiesByTable.insert(tableName, entity);
+}
+
+void QOrmSqliteProviderPrivate::recordChange(const QString& tableName, qint64 rowId)
+{
+    if (tableName == m_writtenTable || m_changedTables.contains(tableName))
+        return;
+
+    QSet<qint64>& rowIds = m_changedRows[tableName];
+    rowIds.insert(rowId);
+
+    // looking up many rows is more expensive than refreshing the whole entity
+    if (rowIds.size() > MaximumChangedRows)
+    {
+        m_changedRows.remove(tableName);
+        m_changedTables.insert(tableName);
+    }
+}
+
+void QOrmSqliteProviderPrivate::detectExternalChanges(
+    QOrmEntityInstanceCache& entityInstanceCache)
+{
+    for (const QString& tableName : qAsConst(m_changedTables))
+    {
+        auto it = m_entitiesByTable.find(tableName);
+
+        if (it != std::end(m_entitiesByTable))
+            entityInstanceCache.markStale(*it);
+    }
+
+    for (auto it = std::cbegin(m_changedRows); it != std::cend(m_changedRows); ++it)
+    {
+        auto entityIt = m_entitiesByTable.find(it.key());
+
+        if (entityIt == std::end(m_entitiesByTable))
+            continue;
+
+        const QOrmMetadata& entity = *entityIt;
+        const QOrmPropertyMapping* objectIdMapping = entity.objectIdMapping();
+
+        // only an INTEGER PRIMARY KEY is an alias of the row ID
+        if (objectIdMapping == nullptr ||
+            QOrmSqliteStatementGenerator::toSqliteType(objectIdMapping->dataType()) !=
+                QLatin1String("INTEGER"))
+        {
+            entityInstanceCache.markStale(entity);
+            continue;
+        }
+
+        for (qint64 rowId : it.value())
+        {
+            QVariant objectId{rowId};
+            objectId.convert(objectIdMapping->dataType());
+
+            QObject* instance = entityInstanceCache.get(entity, objectId);
+
+            if (instance != nullptr)
+                entityInstanceCache.markStale(instance);
+        }
+    }
+
+    m_changedTables.clear();
+    m_changedRows.clear();
+
+    // polled before every query, executed directly to keep it out of the statistics and the
+    // statement observer
+    QSqlQuery query{m_database};
+
+    if (!query.exec(QStringLiteral("PRAGMA data_version")) || !query.next())
+        return;
+
+    qint64 dataVersion = query.value(0).toLongLong();
+
+    // there is no way to tell which rows another connection has changed
+    if (m_dataVersion >= 0 && dataVersion != m_dataVersion)
+    {
+        if (m_sqlConfiguration.verbose())
+            qCDebug(qtorm) << "The database has been changed by another connection";
+
+        entityInstanceCache.markAllStale();
+    }
 
-    if (sqlQuery.lastError().type() != QSqlError::NoError)
-        return QOrmQueryResult<QObject>{{QOrm::ErrorType::Provider, sqlQuery.lastError().text()}};
+    m_dataVersion = dataVersion;
+}
+
+#ifdef QTORM_USE_SQLITE3_API
+sqlite3* QOrmSqliteProviderPrivate::sqliteHandle() const
+{
+    QVariant handle = m_database.driver()->handle();
+
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0)
+        return nullptr;
+
+    return *static_cast<sqlite3* const*>(handle.constData());
+}
+
+void QOrmSqliteProviderPrivate::onSqliteUpdate(void* context,
+                                               int operation,
+                                               const char* databaseName,
+                                               const char* tableName,
+                                               sqlite3_int64 rowId)
+{
+    Q_UNUSED(operation)
+    Q_UNUSED(databaseName)
 
-    return QOrmQueryResult<QObject>{sqlQuery.numRowsAffected()};
+    static_cast<QOrmSqliteProviderPrivate*>(context)->recordChange(
+        QString::fromUtf8(tableName).toLower(), rowId);
 }
+#endif
 
 QOrmSqliteProvider::QOrmSqliteProvider(const QOrmSqliteConfiguration& sqlConfiguration)
     : QOrmAbstractProvider{}
@@ -613,12 +1518,43 @@ QOrmError QOrmSqliteProvider::connectToBackend()
 
     if (!d->m_database.isOpen())
     {
-        d->m_database = QSqlDatabase::addDatabase("QSQLITE");
+        d->m_database = QSqlDatabase::addDatabase("QSQLITE", d->connectionName());
         d->m_database.setConnectOptions(d->m_sqlConfiguration.connectOptions());
         d->m_database.setDatabaseName(d->m_sqlConfiguration.databaseName());
 
         if (!d->m_database.open())
             return d->lastDatabaseError();
+
+        QSqlQuery versionQuery = d->prepareAndExecute(QStringLiteral("SELECT sqlite_version()"));
+
+        if (versionQuery.next())
+            d->m_sqliteVersion = QVersionNumber::fromString(versionQuery.value(0).toString());
+
+        if (d->m_sqlConfiguration.verbose())
+            qCDebug(qtorm) << "Connected to SQLite" << d->m_sqliteVersion;
+
+#ifdef QTORM_USE_SQLITE3_API
+        if (d->m_sqlConfiguration.detectExternalChanges() || d->m_sqlConfiguration.useSqlite3Api())
+        {
+            sqlite3* handle = d->sqliteHandle();
+
+            if (handle == nullptr)
+            {
+                qCWarning(qtorm) << "Unable to access the SQLite handle of the connection";
+            }
+            else
+            {
+                if (d->m_sqlConfiguration.detectExternalChanges())
+                    sqlite3_update_hook(handle, &QOrmSqliteProviderPrivate::onSqliteUpdate, d);
+
+                if (d->m_sqlConfiguration.useSqlite3Api())
+                    d->m_sqliteApiHandle = handle;
+            }
+        }
+#else
+        if (d->m_sqlConfiguration.useSqlite3Api())
+            qCWarning(qtorm) << "QtOrm is built without QTORM_USE_SQLITE3_API, using QtSql instead";
+#endif
     }
 
     return QOrmError{QOrm::ErrorType::None, {}};
@@ -628,8 +1564,30 @@ QOrmError QOrmSqliteProvider::disconnectFromBackend()
 {
     Q_D(QOrmSqliteProvider);
 
+    d->m_preparedStatements.clear();
+
+#ifdef QTORM_USE_SQLITE3_API
+    // the connection cannot be closed while it has unfinalized statements
+    d->m_sqliteApiStatements.clear();
+    d->m_sqliteApiHandle = nullptr;
+
+    if (d->m_database.isOpen())
+    {
+        sqlite3* handle = d->sqliteHandle();
+
+        if (handle != nullptr)
+            sqlite3_update_hook(handle, nullptr, nullptr);
+    }
+#endif
+
+    d->m_changedRows.clear();
+    d->m_changedTables.clear();
+    d->m_dataVersion = -1;
+
     d->m_database.close();
-    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+    // the connection must not be referenced anymore when it is removed
+    d->m_database = QSqlDatabase{};
+    QSqlDatabase::removeDatabase(d->connectionName());
 
     return QOrmError{QOrm::ErrorType::None, {}};
 }
@@ -694,6 +1652,43 @@ QOrmError QOrmSqliteProvider::rollbackTransaction()
     return QOrmError{QOrm::ErrorType::None, {}};
 }
 
+QOrmError QOrmSqliteProvider::createSavepoint(const QString& name)
+{
+    Q_D(QOrmSqliteProvider);
+
+    QSqlQuery query = d->prepareAndExecute(QStringLiteral("SAVEPOINT %1").arg(name));
+
+    if (query.lastError().type() != QSqlError::NoError)
+        return QOrmError{QOrm::ErrorType::Provider, query.lastError().text()};
+
+    return QOrmError{QOrm::ErrorType::None, {}};
+}
+
+QOrmError QOrmSqliteProvider::releaseSavepoint(const QString& name)
+{
+    Q_D(QOrmSqliteProvider);
+
+    QSqlQuery query = d->prepareAndExecute(QStringLiteral("RELEASE SAVEPOINT %1").arg(name));
+
+    if (query.lastError().type() != QSqlError::NoError)
+        return QOrmError{QOrm::ErrorType::Provider, query.lastError().text()};
+
+    return QOrmError{QOrm::ErrorType::None, {}};
+}
+
+QOrmError QOrmSqliteProvider::rollbackToSavepoint(const QString& name)
+{
+    Q_D(QOrmSqliteProvider);
+
+    // ROLLBACK TO leaves the savepoint on the transaction stack, release it afterwards
+    QSqlQuery query = d->prepareAndExecute(QStringLiteral("ROLLBACK TO SAVEPOINT %1").arg(name));
+
+    if (query.lastError().type() != QSqlError::NoError)
+        return QOrmError{QOrm::ErrorType::Provider, query.lastError().text()};
+
+    return releaseSavepoint(name);
+}
+
 QOrmQueryResult<QObject> QOrmSqliteProvider::execute(const QOrmQuery& query,
                                                      QOrmEntityInstanceCache& entityInstanceCache)
 {
@@ -701,25 +1696,115 @@ QOrmQueryResult<QObject> QOrmSqliteProvider::execute(const QOrmQuery& query,
 
     d->ensureSchemaSynchronized(query.relation());
 
+    if (query.relation().type() == QOrm::RelationType::Mapping)
+        d->registerEntity(*query.relation().mapping());
+
     switch (query.operation())
     {
         case QOrm::Operation::Read:
             return d->read(query, entityInstanceCache);
 
+        case QOrm::Operation::Count:
+            return d->count(query);
+
         case QOrm::Operation::Create:
         case QOrm::Operation::Update:
+        {
+            QOrmSqliteWriteScope writeScope{d->m_writtenTable, query};
             return d->merge(query);
+        }
 
         case QOrm::Operation::Delete:
+        {
+            QOrmSqliteWriteScope writeScope{d->m_writtenTable, query};
             return d->remove(query);
+        }
 
         case QOrm::Operation::Merge:
-            Q_ORM_UNEXPECTED_STATE;
+        {
+            QOrmSqliteWriteScope writeScope{d->m_writtenTable, query};
+            return d->upsert(query);
+        }
     }
 
     Q_ORM_UNEXPECTED_STATE;
 }
 
+QOrmError QOrmSqliteProvider::readValues(const QOrmQuery& query, const ValueRowHandler& handler)
+{
+    Q_D(QOrmSqliteProvider);
+
+    d->ensureSchemaSynchronized(query.relation());
+
+    if (query.relation().type() == QOrm::RelationType::Mapping)
+        d->registerEntity(*query.relation().mapping());
+
+    return d->readValues(query, handler);
+}
+
+QOrmAbstractProvider* QOrmSqliteProvider::createBackgroundProvider() const
+{
+    Q_D(const QOrmSqliteProvider);
+
+    static QAtomicInt connectionCounter;
+
+    // every connection to an in-memory database opens a database of its own
+    QString databaseName = d->m_sqlConfiguration.databaseName();
+
+    if (databaseName.isEmpty() || databaseName == QLatin1String(":memory:") ||
+        databaseName.startsWith(QLatin1String("file::memory:")) ||
+        databaseName.contains(QLatin1String("mode=memory")))
+    {
+        return nullptr;
+    }
+
+    QOrmSqliteConfiguration configuration = d->m_sqlConfiguration;
+    configuration.setConnectionName(QStringLiteral("%1_background_%2")
+                                        .arg(d->connectionName())
+                                        .arg(connectionCounter.fetchAndAddRelaxed(1)));
+    configuration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Bypass);
+    // the instances read by the worker are not kept
+    configuration.setDetectExternalChanges(false);
+
+    return new QOrmSqliteProvider{configuration};
+}
+
+QOrmError QOrmSqliteProvider::synchronizeSchema(const QOrmRelation& relation)
+{
+    Q_D(QOrmSqliteProvider);
+
+    return d->ensureSchemaSynchronized(relation);
+}
+
+void QOrmSqliteProvider::detectExternalChanges(QOrmEntityInstanceCache& entityInstanceCache)
+{
+    Q_D(QOrmSqliteProvider);
+
+    if (d->m_sqlConfiguration.detectExternalChanges() && d->m_database.isOpen())
+        d->detectExternalChanges(entityInstanceCache);
+}
+
+QOrmStatistics QOrmSqliteProvider::statistics() const
+{
+    Q_D(const QOrmSqliteProvider);
+
+    return d->m_statistics;
+}
+
+void QOrmSqliteProvider::resetStatistics()
+{
+    Q_D(QOrmSqliteProvider);
+
+    d->m_statistics.reset();
+}
+
+void QOrmSqliteProvider::setStatementObserver(QOrmStatistics::StatementObserver observer)
+{
+    Q_D(QOrmSqliteProvider);
+
+    d->m_statementObserver = std::move(observer);
+}
+
 QOrmSqliteConfiguration QOrmSqliteProvider::configuration() const
 {
     Q_D(const QOrmSqliteProvider);
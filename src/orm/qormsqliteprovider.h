@@ -47,8 +47,21 @@ public:
     QOrmError commitTransaction() override;
     QOrmError rollbackTransaction() override;
 
+    QOrmError createSavepoint(const QString& name) override;
+    QOrmError releaseSavepoint(const QString& name) override;
+    QOrmError rollbackToSavepoint(const QString& name) override;
+
     QOrmQueryResult<QObject> execute(const QOrmQuery& query,
                                      QOrmEntityInstanceCache& entityInstanceCache) override;
+    QOrmError readValues(const QOrmQuery& query, const ValueRowHandler& handler) override;
+
+    QOrmAbstractProvider* createBackgroundProvider() const override;
+    QOrmError synchronizeSchema(const QOrmRelation& relation) override;
+    void detectExternalChanges(QOrmEntityInstanceCache& entityInstanceCache) override;
+
+    QOrmStatistics statistics() const override;
+    void resetStatistics() override;
+    void setStatementObserver(QOrmStatistics::StatementObserver observer) override;
 
     QOrmSqliteConfiguration configuration() const;
     QSqlDatabase database() const;
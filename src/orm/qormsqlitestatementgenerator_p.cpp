@@ -55,7 +55,7 @@ static QVariant propertyValueForQuery(const QObject* entityInstance,
         Q_ASSERT(referencedEntity->objectIdMapping() != nullptr);
 
         const QObject* referencedInstance =
-            QOrmPrivate::propertyValue(entityInstance, propertyMapping.classPropertyName())
+            QOrmPrivate::propertyValue(entityInstance, propertyMapping)
                 .value<QObject*>();
 
         return referencedInstance == nullptr
@@ -64,7 +64,7 @@ static QVariant propertyValueForQuery(const QObject* entityInstance,
     }
     else
     {
-        return QOrmPrivate::propertyValue(entityInstance, propertyMapping.classPropertyName());
+        return QOrmPrivate::propertyValue(entityInstance, propertyMapping);
     }
 }
 
@@ -90,9 +90,18 @@ QString QOrmSqliteStatementGenerator::generate(const QOrmQuery& query, QVariantM
                                            query.entityInstance(),
                                            boundParameters);
 
+        case QOrm::Operation::Merge:
+            return generateUpsertStatement(*query.relation().mapping(),
+                                           query.entityInstance(),
+                                           boundParameters,
+                                           true);
+
         case QOrm::Operation::Read:
             return generateSelectStatement(query, boundParameters);
 
+        case QOrm::Operation::Count:
+            return generateCountStatement(query, boundParameters);
+
         case QOrm::Operation::Delete:
             Q_ASSERT(query.relation().type() == QOrm::RelationType::Mapping);
 
@@ -177,6 +186,62 @@ QString QOrmSqliteStatementGenerator::generateUpdateStatement(const QOrmMetadata
     return parts.join(QChar(' '));
 }
 
+QString QOrmSqliteStatementGenerator::generateUpsertStatement(const QOrmMetadata& relation,
+                                                              const QObject* entityInstance,
+                                                              QVariantMap& boundParameters,
+                                                              bool returnObjectId)
+{
+    const QOrmPropertyMapping* objectIdMapping = relation.objectIdMapping();
+
+    if (objectIdMapping == nullptr)
+        qFatal("QtORM: Unable to upsert entity without object ID property");
+
+    QStringList fieldsList;
+    QStringList valuesList;
+    QStringList setList;
+
+    for (const QOrmPropertyMapping& propertyMapping : relation.propertyMappings())
+    {
+        if (propertyMapping.isTransient())
+            continue;
+
+        QVariant propertyValue = propertyValueForQuery(entityInstance, propertyMapping);
+
+        if (propertyMapping.isObjectId())
+        {
+            // an instance that was never written has no object ID yet: let the database assign it
+            if (propertyMapping.isAutogenerated() &&
+                (propertyValue.isNull() || propertyValue.toLongLong() == 0))
+            {
+                propertyValue = QVariant::fromValue(nullptr);
+            }
+        }
+        else
+        {
+            setList.push_back(
+                QStringLiteral("%1 = excluded.%1").arg(propertyMapping.tableFieldName()));
+        }
+
+        fieldsList.push_back(propertyMapping.tableFieldName());
+        valuesList.push_back(
+            insertParameter(boundParameters, propertyMapping.tableFieldName(), propertyValue));
+    }
+
+    QStringList parts = {QStringLiteral("INSERT INTO %1(%2) VALUES(%3)")
+                             .arg(relation.tableName(), fieldsList.join(','), valuesList.join(',')),
+                         QStringLiteral("ON CONFLICT(%1)").arg(objectIdMapping->tableFieldName())};
+
+    if (setList.isEmpty())
+        parts += "DO NOTHING";
+    else
+        parts += "DO UPDATE SET " % setList.join(',');
+
+    if (returnObjectId)
+        parts += "RETURNING " % objectIdMapping->tableFieldName();
+
+    return parts.join(QChar{' '});
+}
+
 QString QOrmSqliteStatementGenerator::generateSelectStatement(const QOrmQuery& query,
                                                               QVariantMap& boundParameters)
 {
@@ -189,6 +254,26 @@ QString QOrmSqliteStatementGenerator::generateSelectStatement(const QOrmQuery& q
 
     parts += generateOrderClause(query.order());
 
+    // SQLite requires a LIMIT clause for an OFFSET, -1 means no limit
+    if (query.limit().has_value() || query.offset() > 0)
+        parts += QStringLiteral("LIMIT %1").arg(query.limit().value_or(-1));
+
+    if (query.offset() > 0)
+        parts += QStringLiteral("OFFSET %1").arg(query.offset());
+
+    return parts.join(QChar{' '});
+}
+
+QString QOrmSqliteStatementGenerator::generateCountStatement(const QOrmQuery& query,
+                                                             QVariantMap& boundParameters)
+{
+    Q_ASSERT(query.operation() == QOrm::Operation::Count);
+
+    QStringList parts = {"SELECT COUNT(*)", generateFromClause(query.relation(), boundParameters)};
+
+    if (query.filter().has_value())
+        parts += generateWhereClause(*query.filter(), boundParameters);
+
     return parts.join(QChar{' '});
 }
 
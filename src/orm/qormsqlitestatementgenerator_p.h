@@ -63,9 +63,18 @@ public:
                                            const QObject* instance,
                                            QVariantMap& boundParameters);
 
+    Q_REQUIRED_RESULT
+    static QString generateUpsertStatement(const QOrmMetadata& relation,
+                                           const QObject* instance,
+                                           QVariantMap& boundParameters,
+                                           bool returnObjectId);
+
     Q_REQUIRED_RESULT
     static QString generateSelectStatement(const QOrmQuery& query, QVariantMap& boundParameters);
 
+    Q_REQUIRED_RESULT
+    static QString generateCountStatement(const QOrmQuery& query, QVariantMap& boundParameters);
+
     Q_REQUIRED_RESULT
     static QString generateDeleteStatement(const QOrmMetadata& relation,
                                            const QOrmFilter& filter,
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "qormstatistics.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+QDebug operator<<(QDebug dbg, const QOrmLatencyHistogram& histogram)
+{
+    QDebugStateSaver saver{dbg};
+
+    dbg.nospace() << "QOrmLatencyHistogram(count " << histogram.count();
+
+    if (histogram.count() > 0)
+    {
+        dbg << ", mean " << histogram.totalNanoseconds() / histogram.count() / 1000 << " µs"
+            << ", p50 <= " << histogram.percentileNanoseconds(0.5) / 1000 << " µs"
+            << ", p99 <= " << histogram.percentileNanoseconds(0.99) / 1000 << " µs"
+            << ", max " << histogram.maximumNanoseconds() / 1000 << " µs";
+    }
+
+    dbg << ")";
+
+    return dbg;
+}
+
+QDebug operator<<(QDebug dbg, const QOrmStatistics& statistics)
+{
+    QDebugStateSaver saver{dbg};
+
+    dbg.nospace() << "QOrmStatistics(statements " << statistics.statements().size()
+                  << ", rows read " << statistics.rowsRead() << ", rows written "
+                  << statistics.rowsWritten() << ", cache hit rate " << statistics.cacheHitRate()
+                  << ", prepare " << statistics.prepareLatency() << ", execute "
+                  << statistics.executeLatency() << ", hydrate " << statistics.hydrateLatency()
+                  << ", schema synchronization " << statistics.schemaSynchronizationLatency()
+                  << ")";
+
+    return dbg;
+}
+
+void QOrmLatencyHistogram::record(qint64 nanoseconds)
+{
+    nanoseconds = std::max<qint64>(nanoseconds, 0);
+
+    qint64 microseconds = nanoseconds / 1000;
+    int index = 0;
+
+    while (microseconds > 0 && index < BucketCount - 1)
+    {
+        microseconds >>= 1;
+        ++index;
+    }
+
+    ++m_buckets[static_cast<size_t>(index)];
+    ++m_count;
+    m_totalNanoseconds += nanoseconds;
+    m_maximumNanoseconds = std::max(m_maximumNanoseconds, nanoseconds);
+}
+
+qint64 QOrmLatencyHistogram::percentileNanoseconds(double percentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    auto rank = static_cast<qint64>(std::ceil(std::clamp(percentile, 0.0, 1.0) * m_count));
+    qint64 counted = 0;
+
+    for (int i = 0; i < BucketCount - 1; ++i)
+    {
+        counted += m_buckets[static_cast<size_t>(i)];
+
+        if (counted >= rank)
+            return std::min((qint64{1} << i) * 1000, m_maximumNanoseconds);
+    }
+
+    return m_maximumNanoseconds;
+}
+
+QOrmStatementEvent::QOrmStatementEvent(const QString& statement,
+                                       qint64 prepareNanoseconds,
+                                       qint64 executeNanoseconds,
+                                       bool isSuccessful)
+    : m_statement{statement}
+    , m_prepareNanoseconds{prepareNanoseconds}
+    , m_executeNanoseconds{executeNanoseconds}
+    , m_isSuccessful{isSuccessful}
+{
+}
+
+double QOrmStatistics::cacheHitRate() const
+{
+    qint64 lookups = m_cacheHits + m_cacheMisses;
+
+    return lookups > 0 ? static_cast<double>(m_cacheHits) / lookups : 0.0;
+}
+
+void QOrmStatistics::recordStatement(const QOrmStatementEvent& event)
+{
+    QOrmStatementStatistics& statement = m_statements[event.statement()];
+
+    ++statement.m_executions;
+    statement.m_executeLatency.record(event.executeNanoseconds());
+    m_executeLatency.record(event.executeNanoseconds());
+
+    if (event.prepareNanoseconds() > 0)
+    {
+        statement.m_prepareLatency.record(event.prepareNanoseconds());
+        m_prepareLatency.record(event.prepareNanoseconds());
+    }
+
+    if (!event.isSuccessful())
+        ++statement.m_errors;
+}
+
+void QOrmStatistics::recordRows(const QString& statement, qint64 rowsRead, qint64 rowsWritten)
+{
+    auto it = m_statements.find(statement);
+
+    if (it != std::end(m_statements))
+    {
+        it->m_rowsRead += rowsRead;
+        it->m_rowsWritten += rowsWritten;
+    }
+
+    m_rowsRead += rowsRead;
+    m_rowsWritten += rowsWritten;
+}
+
+void QOrmStatistics::recordHydration(qint64 nanoseconds)
+{
+    m_hydrateLatency.record(nanoseconds);
+}
+
+void QOrmStatistics::recordSchemaSynchronization(qint64 nanoseconds)
+{
+    m_schemaSynchronizationLatency.record(nanoseconds);
+}
+
+void QOrmStatistics::setCacheLookups(qint64 hits, qint64 misses)
+{
+    m_cacheHits = hits;
+    m_cacheMisses = misses;
+}
+
+void QOrmStatistics::reset()
+{
+    *this = QOrmStatistics{};
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef QORMSTATISTICS_H
+#define QORMSTATISTICS_H
+
+#include <QtOrm/qormglobal.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <array>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QDebug;
+
+// Durations counted in buckets with exponentially growing bounds. Bucket 0 counts durations
+// below 1 µs, bucket i durations from 2^(i-1) µs up to 2^i µs. The last bucket also counts all
+// longer durations.
+class Q_ORM_EXPORT QOrmLatencyHistogram
+{
+public:
+    static constexpr int BucketCount = 32;
+
+    void record(qint64 nanoseconds);
+
+    Q_REQUIRED_RESULT
+    qint64 count() const { return m_count; }
+
+    Q_REQUIRED_RESULT
+    qint64 totalNanoseconds() const { return m_totalNanoseconds; }
+
+    Q_REQUIRED_RESULT
+    qint64 maximumNanoseconds() const { return m_maximumNanoseconds; }
+
+    Q_REQUIRED_RESULT
+    qint64 bucket(int index) const { return m_buckets[static_cast<size_t>(index)]; }
+
+    // The upper bound of the bucket containing the percentile, e.g. 0.99 for p99
+    Q_REQUIRED_RESULT
+    qint64 percentileNanoseconds(double percentile) const;
+
+private:
+    std::array<qint64, BucketCount> m_buckets{};
+    qint64 m_count{0};
+    qint64 m_totalNanoseconds{0};
+    qint64 m_maximumNanoseconds{0};
+};
+
+// An execution of an SQL statement reported by the provider
+class Q_ORM_EXPORT QOrmStatementEvent
+{
+public:
+    QOrmStatementEvent(const QString& statement,
+                       qint64 prepareNanoseconds,
+                       qint64 executeNanoseconds,
+                       bool isSuccessful);
+
+    Q_REQUIRED_RESULT
+    QString statement() const { return m_statement; }
+
+    // zero if a prepared statement has been reused
+    Q_REQUIRED_RESULT
+    qint64 prepareNanoseconds() const { return m_prepareNanoseconds; }
+
+    Q_REQUIRED_RESULT
+    qint64 executeNanoseconds() const { return m_executeNanoseconds; }
+
+    Q_REQUIRED_RESULT
+    bool isSuccessful() const { return m_isSuccessful; }
+
+private:
+    QString m_statement;
+    qint64 m_prepareNanoseconds{0};
+    qint64 m_executeNanoseconds{0};
+    bool m_isSuccessful{true};
+};
+
+class Q_ORM_EXPORT QOrmStatementStatistics
+{
+    friend class QOrmStatistics;
+
+public:
+    Q_REQUIRED_RESULT
+    qint64 executions() const { return m_executions; }
+
+    Q_REQUIRED_RESULT
+    qint64 errors() const { return m_errors; }
+
+    Q_REQUIRED_RESULT
+    qint64 rowsRead() const { return m_rowsRead; }
+
+    Q_REQUIRED_RESULT
+    qint64 rowsWritten() const { return m_rowsWritten; }
+
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& prepareLatency() const { return m_prepareLatency; }
+
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& executeLatency() const { return m_executeLatency; }
+
+private:
+    qint64 m_executions{0};
+    qint64 m_errors{0};
+    qint64 m_rowsRead{0};
+    qint64 m_rowsWritten{0};
+    QOrmLatencyHistogram m_prepareLatency;
+    QOrmLatencyHistogram m_executeLatency;
+};
+
+// Counters and latencies collected by a session and its provider since the session has been
+// created or the statistics have been reset
+class Q_ORM_EXPORT QOrmStatistics
+{
+public:
+    using StatementObserver = std::function<void(const QOrmStatementEvent& event)>;
+
+    Q_REQUIRED_RESULT
+    const QHash<QString, QOrmStatementStatistics>& statements() const { return m_statements; }
+
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& prepareLatency() const { return m_prepareLatency; }
+
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& executeLatency() const { return m_executeLatency; }
+
+    // time spent reading the rows of a query and creating or refreshing entity instances
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& hydrateLatency() const { return m_hydrateLatency; }
+
+    Q_REQUIRED_RESULT
+    const QOrmLatencyHistogram& schemaSynchronizationLatency() const
+    {
+        return m_schemaSynchronizationLatency;
+    }
+
+    Q_REQUIRED_RESULT
+    qint64 rowsRead() const { return m_rowsRead; }
+
+    Q_REQUIRED_RESULT
+    qint64 rowsWritten() const { return m_rowsWritten; }
+
+    // lookups of entity instances in the instance cache of the session
+    Q_REQUIRED_RESULT
+    qint64 cacheHits() const { return m_cacheHits; }
+
+    Q_REQUIRED_RESULT
+    qint64 cacheMisses() const { return m_cacheMisses; }
+
+    Q_REQUIRED_RESULT
+    double cacheHitRate() const;
+
+    void recordStatement(const QOrmStatementEvent& event);
+    void recordRows(const QString& statement, qint64 rowsRead, qint64 rowsWritten);
+    void recordHydration(qint64 nanoseconds);
+    void recordSchemaSynchronization(qint64 nanoseconds);
+    void setCacheLookups(qint64 hits, qint64 misses);
+
+    void reset();
+
+private:
+    QHash<QString, QOrmStatementStatistics> m_statements;
+    QOrmLatencyHistogram m_prepareLatency;
+    QOrmLatencyHistogram m_executeLatency;
+    QOrmLatencyHistogram m_hydrateLatency;
+    QOrmLatencyHistogram m_schemaSynchronizationLatency;
+    qint64 m_rowsRead{0};
+    qint64 m_rowsWritten{0};
+    qint64 m_cacheHits{0};
+    qint64 m_cacheMisses{0};
+};
+
+extern Q_ORM_EXPORT QDebug operator<<(QDebug dbg, const QOrmLatencyHistogram& histogram);
+extern Q_ORM_EXPORT QDebug operator<<(QDebug dbg, const QOrmStatistics& statistics);
+
+QT_END_NAMESPACE
+
+#endif // QORMSTATISTICS_H
@@ -48,7 +48,8 @@ QOrmTransactionToken& QOrmTransactionToken::operator=(QOrmTransactionToken&&) =
 
 QOrmTransactionToken::~QOrmTransactionToken()
 {
-    if (d->m_engaged)
+    // moved-from tokens have no private part
+    if (d != nullptr && d->m_engaged)
     {
         if (d->m_action == QOrm::TransactionAction::Commit)
             d->m_session->commitTransaction();
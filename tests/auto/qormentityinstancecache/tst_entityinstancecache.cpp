@@ -41,6 +41,10 @@ private slots:
 
     void testWithObjectId();
     void testModificationTracked();
+    void testTrimEvictsLeastRecentlyUsed();
+    void testTrimEvictsReferencedInstancesTogether();
+    void testPinnedInstancesKept();
+    void testEvictReferencedInstances();
 };
 
 EntityInstanceCache::EntityInstanceCache()
@@ -115,6 +119,145 @@ void EntityInstanceCache::testModificationTracked()
     QVERIFY(!instanceCache.isModified(upperAustria));
 }
 
+void EntityInstanceCache::testTrimEvictsLeastRecentlyUsed()
+{
+    QOrmMetadataCache metadataCache;
+    const QOrmMetadata& metadata = metadataCache.get<Province>();
+    QOrmEntityInstanceCache instanceCache;
+    instanceCache.setMaximumSize(4);
+
+    QVector<QPointer<Province>> provinces;
+
+    for (int i = 1; i <= 5; ++i)
+    {
+        Province* province = new Province(i, QString{"Province %1"}.arg(i));
+        instanceCache.insert(metadata, province);
+        instanceCache.finalize(metadata, province);
+        provinces.push_back(province);
+    }
+
+    // the least recently used instances are 3 and 4
+    QCOMPARE(instanceCache.get(metadata, 1), provinces[0].data());
+    QCOMPARE(instanceCache.get(metadata, 2), provinces[1].data());
+
+    instanceCache.trim();
+
+    QCOMPARE(instanceCache.size(), 3);
+    QVERIFY(!provinces[0].isNull());
+    QVERIFY(!provinces[1].isNull());
+    QVERIFY(provinces[2].isNull());
+    QVERIFY(provinces[3].isNull());
+    QVERIFY(!provinces[4].isNull());
+    QCOMPARE(instanceCache.get(metadata, 3), nullptr);
+
+    // the cache is within its limit now
+    instanceCache.trim();
+    QCOMPARE(instanceCache.size(), 3);
+}
+
+void EntityInstanceCache::testTrimEvictsReferencedInstancesTogether()
+{
+    QOrmMetadataCache metadataCache;
+    QOrmEntityInstanceCache instanceCache;
+    instanceCache.setMaximumSize(2);
+
+    QPointer<Province> lowerAustria = new Province(2, QString::fromUtf8("Niederösterreich"));
+    QPointer<Province> upperAustria = new Province(1, QString::fromUtf8("Oberösterreich"));
+    QPointer<Town> hagenberg = new Town(1, QString::fromUtf8("Hagenberg"), upperAustria);
+
+    instanceCache.insert(metadataCache.get<Province>(), lowerAustria);
+    instanceCache.insert(metadataCache.get<Province>(), upperAustria);
+    instanceCache.insert(metadataCache.get<Town>(), hagenberg);
+
+    QCOMPARE(instanceCache.get(metadataCache.get<Province>(), 2), lowerAustria.data());
+
+    // Evicting the least recently used province is enough to meet the limit, but the town
+    // referencing it would be left with a dangling pointer
+    instanceCache.trim();
+
+    QCOMPARE(instanceCache.size(), 1);
+    QVERIFY(upperAustria.isNull());
+    QVERIFY(hagenberg.isNull());
+    QVERIFY(!lowerAustria.isNull());
+}
+
+void EntityInstanceCache::testPinnedInstancesKept()
+{
+    QOrmMetadataCache metadataCache;
+    const QOrmMetadata& metadata = metadataCache.get<Province>();
+    QOrmEntityInstanceCache instanceCache;
+    instanceCache.setMaximumSize(1);
+
+    QPointer<Province> pinned = new Province(1, QString::fromUtf8("Oberösterreich"));
+    QPointer<Province> modified = new Province(2, QString::fromUtf8("Niederösterreich"));
+    QPointer<Province> unused = new Province(3, QString::fromUtf8("Tirol"));
+
+    for (Province* province : {pinned.data(), modified.data(), unused.data()})
+    {
+        instanceCache.insert(metadata, province);
+        instanceCache.finalize(metadata, province);
+    }
+
+    instanceCache.pin(pinned);
+    QVERIFY(instanceCache.isPinned(pinned));
+
+    modified->setName(QString::fromUtf8("Lower Austria"));
+
+    instanceCache.trim();
+
+    QCOMPARE(instanceCache.size(), 2);
+    QVERIFY(!pinned.isNull());
+    QVERIFY(!modified.isNull());
+    QVERIFY(unused.isNull());
+
+    QVERIFY(!instanceCache.evict(pinned));
+    QVERIFY(instanceCache.contains(pinned));
+
+    // unsaved changes are kept as well
+    instanceCache.clear();
+    QCOMPARE(instanceCache.size(), 2);
+    QVERIFY(!pinned.isNull());
+    QVERIFY(!modified.isNull());
+    QVERIFY(!instanceCache.evict(modified));
+
+    instanceCache.unpin(pinned);
+    QVERIFY(!instanceCache.isPinned(pinned));
+    QVERIFY(instanceCache.evict(pinned));
+    QVERIFY(pinned.isNull());
+    QCOMPARE(instanceCache.size(), 1);
+}
+
+void EntityInstanceCache::testEvictReferencedInstances()
+{
+    QOrmMetadataCache metadataCache;
+    QOrmEntityInstanceCache instanceCache;
+
+    QPointer<Province> lowerAustria = new Province(2, QString::fromUtf8("Niederösterreich"));
+    QPointer<Province> upperAustria = new Province(1, QString::fromUtf8("Oberösterreich"));
+    QPointer<Town> hagenberg = new Town(1, QString::fromUtf8("Hagenberg"), upperAustria);
+
+    instanceCache.insert(metadataCache.get<Province>(), lowerAustria);
+    instanceCache.insert(metadataCache.get<Province>(), upperAustria);
+    instanceCache.insert(metadataCache.get<Town>(), hagenberg);
+
+    // a pinned town keeps the province it references
+    instanceCache.pin(hagenberg);
+    QVERIFY(!instanceCache.evict(upperAustria));
+
+    instanceCache.clear();
+    QCOMPARE(instanceCache.size(), 2);
+    QVERIFY(lowerAustria.isNull());
+    QVERIFY(!upperAustria.isNull());
+    QVERIFY(!hagenberg.isNull());
+
+    // the town would be left with a dangling pointer, it is evicted with its province
+    instanceCache.unpin(hagenberg);
+    QVERIFY(instanceCache.evict(upperAustria));
+    QVERIFY(upperAustria.isNull());
+    QVERIFY(hagenberg.isNull());
+    QCOMPARE(instanceCache.size(), 0);
+}
+
 QTEST_APPLESS_MAIN(EntityInstanceCache)
 
 #include "tst_entityinstancecache.moc"
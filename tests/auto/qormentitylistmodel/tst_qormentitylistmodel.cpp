@@ -28,6 +28,16 @@
 #include "domain/province.h"
 #include "domain/town.h"
 
+static QStringList names(const QOrmEntityListModelBase& model)
+{
+    QStringList names;
+
+    for (int i = 0; i < model.rowCount(); ++i)
+        names.push_back(model.at(i)->property("name").toString());
+
+    return names;
+}
+
 class EntityListModelTest : public QObject
 {
     Q_OBJECT
@@ -36,6 +46,11 @@ private slots:
     void initTestCase();
 
     void testQVectorTInData();
+    void testIncrementalChanges();
+    void testReferenceFilter();
+    void testFetchMore();
+    void testBackgroundRead();
+    void testInMemorySortAndFilter();
 };
 
 void EntityListModelTest::initTestCase()
@@ -88,6 +103,224 @@ void EntityListModelTest::testQVectorTInData()
     QCOMPARE(hagenberg->name(), QString::fromUtf8("Hagenberg"));
 }
 
+void EntityListModelTest::testIncrementalChanges()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* tirol = new Province(QString::fromUtf8("Tirol"));
+
+    QVERIFY(session.merge(upperAustria, tirol));
+
+    QOrmEntityListModel<Province> provinces{session};
+    provinces.setOrder({QStringLiteral("name")});
+
+    QSignalSpy resetSpy{&provinces, &QAbstractItemModel::modelReset};
+    QSignalSpy insertSpy{&provinces, &QAbstractItemModel::rowsInserted};
+    QSignalSpy changeSpy{&provinces, &QAbstractItemModel::dataChanged};
+    QSignalSpy moveSpy{&provinces, &QAbstractItemModel::rowsMoved};
+    QSignalSpy removeSpy{&provinces, &QAbstractItemModel::rowsRemoved};
+
+    // a new instance is inserted at its position in the order
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+    QVERIFY(session.merge(lowerAustria));
+
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy[0][1].toInt(), 0);
+    QCOMPARE(provinces.totalCount(), 3);
+    QCOMPARE(names(provinces),
+             (QStringList{QString::fromUtf8("Niederösterreich"),
+                          QString::fromUtf8("Oberösterreich"),
+                          QString::fromUtf8("Tirol")}));
+    QCOMPARE(provinces.indexOf(lowerAustria), 0);
+    QCOMPARE(provinces.indexOf(upperAustria), 1);
+    QCOMPARE(provinces.indexOf(tirol), 2);
+
+    // an updated instance changes its row and moves if its position in the order has changed
+    lowerAustria->setName(QString::fromUtf8("Wien"));
+    QVERIFY(session.merge(lowerAustria));
+
+    QCOMPARE(changeSpy.count(), 1);
+    QCOMPARE(moveSpy.count(), 1);
+    QCOMPARE(provinces.at(2), static_cast<QObject*>(lowerAustria));
+    QCOMPARE(provinces.indexOf(upperAustria), 0);
+    QCOMPARE(provinces.indexOf(tirol), 1);
+    QCOMPARE(provinces.indexOf(lowerAustria), 2);
+
+    // a removed instance removes its row only
+    QVERIFY(session.remove(upperAustria));
+
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(removeSpy[0][1].toInt(), 0);
+    QCOMPARE(provinces.totalCount(), 2);
+    QCOMPARE(names(provinces),
+             (QStringList{QString::fromUtf8("Tirol"), QString::fromUtf8("Wien")}));
+    QCOMPARE(provinces.indexOf(tirol), 0);
+    QCOMPARE(provinces.indexOf(lowerAustria), 1);
+
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void EntityListModelTest::testReferenceFilter()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+
+    QVERIFY(session.merge(upperAustria, lowerAustria));
+
+    QOrmEntityListModel<Town> towns{session};
+    towns.setFilter({{QStringLiteral("province"), QVariant::fromValue(upperAustria)}});
+    QCOMPARE(towns.rowCount(), 0);
+
+    QSignalSpy insertSpy{&towns, &QAbstractItemModel::rowsInserted};
+
+    // a town of another province is not inserted
+    QObject* melk = towns.create({{QStringLiteral("name"), QStringLiteral("Melk")},
+                                  {QStringLiteral("province"),
+                                   QVariant::fromValue(lowerAustria)}});
+    QVERIFY(melk != nullptr);
+
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(towns.rowCount(), 0);
+    QCOMPARE(towns.indexOf(melk), -1);
+
+    QObject* hagenberg = towns.create({{QStringLiteral("name"), QStringLiteral("Hagenberg")},
+                                       {QStringLiteral("province"),
+                                        QVariant::fromValue(upperAustria)}});
+    QVERIFY(hagenberg != nullptr);
+
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(names(towns), QStringList{"Hagenberg"});
+    QCOMPARE(towns.totalCount(), 1);
+}
+
+void EntityListModelTest::testFetchMore()
+{
+    QOrmSession session;
+
+    for (const char* name : {"Hagenberg", "Pregarten", "Melk", "Freistadt", "Linz"})
+        QVERIFY(session.merge(new Town{QString::fromUtf8(name), nullptr}));
+
+    // without an order, the pages follow the object IDs
+    QOrmEntityListModel<Town> towns{session, 2};
+
+    QCOMPARE(towns.totalCount(), 5);
+    QCOMPARE(names(towns), (QStringList{"Hagenberg", "Pregarten"}));
+    QVERIFY(towns.canFetchMore({}));
+
+    towns.fetchMore({});
+    QCOMPARE(names(towns), (QStringList{"Hagenberg", "Pregarten", "Melk", "Freistadt"}));
+    QVERIFY(towns.canFetchMore({}));
+
+    towns.fetchMore({});
+    QCOMPARE(names(towns),
+             (QStringList{"Hagenberg", "Pregarten", "Melk", "Freistadt", "Linz"}));
+    QVERIFY(!towns.canFetchMore({}));
+
+    // with an order, the pages are read with an offset
+    QOrmEntityListModel<Town> sortedTowns{session, 2};
+    sortedTowns.setOrder({QStringLiteral("name")});
+
+    QCOMPARE(sortedTowns.totalCount(), 5);
+    QCOMPARE(names(sortedTowns), (QStringList{"Freistadt", "Hagenberg"}));
+    QVERIFY(sortedTowns.canFetchMore({}));
+
+    sortedTowns.fetchMore({});
+    QCOMPARE(names(sortedTowns), (QStringList{"Freistadt", "Hagenberg", "Linz", "Melk"}));
+
+    sortedTowns.fetchMore({});
+    QCOMPARE(names(sortedTowns),
+             (QStringList{"Freistadt", "Hagenberg", "Linz", "Melk", "Pregarten"}));
+    QVERIFY(!sortedTowns.canFetchMore({}));
+}
+
+void EntityListModelTest::testBackgroundRead()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+    Province* tirol = new Province(QString::fromUtf8("Tirol"));
+
+    QVERIFY(session.merge(upperAustria, lowerAustria, tirol));
+
+    // the rows arrive after the read has completed
+    QOrmEntityListModel<Province> provinces{session, 0, true};
+    QVERIFY(provinces.isLoading());
+    QCOMPARE(provinces.rowCount(), 0);
+
+    QTRY_VERIFY(!provinces.isLoading());
+    QCOMPARE(provinces.rowCount(), 3);
+    QCOMPARE(provinces.totalCount(), 3);
+
+    provinces.setFilter({{QStringLiteral("name"), QStringLiteral("Tirol")}});
+    QTRY_VERIFY(!provinces.isLoading());
+    QCOMPARE(names(provinces), QStringList{"Tirol"});
+
+    // a superseded read is cancelled: its rows are never shown
+    QSignalSpy insertSpy{&provinces, &QAbstractItemModel::rowsInserted};
+    QSignalSpy resetSpy{&provinces, &QAbstractItemModel::modelReset};
+
+    provinces.setFilter({});
+    QVERIFY(provinces.isLoading());
+    provinces.setFilter({{QStringLiteral("name"), QStringLiteral("Tirol")}});
+    QVERIFY(provinces.isLoading());
+
+    QTRY_VERIFY(!provinces.isLoading());
+    QCOMPARE(names(provinces), QStringList{"Tirol"});
+    QCOMPARE(insertSpy.count(), 0);
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void EntityListModelTest::testInMemorySortAndFilter()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+    Province* tirol = new Province(QString::fromUtf8("Tirol"));
+
+    QVERIFY(session.merge(upperAustria, lowerAustria, tirol));
+
+    QOrmEntityListModel<Province> provinces{session};
+    session.resetStatistics();
+
+    QSignalSpy layoutSpy{&provinces, &QAbstractItemModel::layoutChanged};
+    QSignalSpy resetSpy{&provinces, &QAbstractItemModel::modelReset};
+
+    // all rows are resident: they are sorted and narrowed without reading them again
+    provinces.setOrder(
+        {QVariantMap{{QStringLiteral("name"), QVariant::fromValue(Qt::DescendingOrder)}}});
+
+    QCOMPARE(layoutSpy.count(), 1);
+    QCOMPARE(names(provinces),
+             (QStringList{QString::fromUtf8("Tirol"),
+                          QString::fromUtf8("Oberösterreich"),
+                          QString::fromUtf8("Niederösterreich")}));
+    QCOMPARE(provinces.indexOf(tirol), 0);
+    QCOMPARE(provinces.indexOf(lowerAustria), 2);
+
+    provinces.setFilter({{QStringLiteral("name"), QString::fromUtf8("Oberösterreich")}});
+
+    QCOMPARE(names(provinces), QStringList{QString::fromUtf8("Oberösterreich")});
+    QCOMPARE(provinces.totalCount(), 1);
+    QCOMPARE(session.statistics().rowsRead(), qint64{0});
+    QCOMPARE(resetSpy.count(), 0);
+
+    // a wider filter reads the rows again
+    provinces.setFilter({});
+
+    QCOMPARE(names(provinces),
+             (QStringList{QString::fromUtf8("Tirol"),
+                          QString::fromUtf8("Oberösterreich"),
+                          QString::fromUtf8("Niederösterreich")}));
+    QCOMPARE(provinces.totalCount(), 3);
+    QCOMPARE(session.statistics().rowsRead(), qint64{3});
+}
+
 QTEST_GUILESS_MAIN(EntityListModelTest)
 
 #include "tst_qormentitylistmodel.moc"
@@ -20,12 +20,86 @@
 
 #include <QtTest>
 
+#include <QOrmColumn>
 #include <QOrmMetadataCache>
+#include <QOrmPropertyMapping>
 
 #include "domain/person.h"
 #include "domain/province.h"
 #include "domain/town.h"
 
+class Country : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int id READ id WRITE setId NOTIFY idChanged)
+    Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
+
+public:
+    Q_INVOKABLE Country(QObject* parent = nullptr)
+        : QObject{parent}
+    {
+    }
+
+    int id() const { return m_id; }
+    void setId(int id)
+    {
+        m_id = id;
+        emit idChanged();
+    }
+
+    QString name() const { return m_name; }
+    void setName(const QString& name)
+    {
+        m_name = name;
+        emit nameChanged();
+    }
+
+signals:
+    void idChanged();
+    void nameChanged();
+
+private:
+    int m_id{0};
+    QString m_name;
+};
+
+template<>
+struct QOrmEntityTraits<Country>
+{
+    static constexpr const char* tableName = "countries";
+    static constexpr QOrmColumn columns[] = {
+        qOrmColumn<&Country::id, &Country::setId>("id"),
+        qOrmColumn<&Country::name, &Country::setName>("name", "country_name")};
+};
+
+// registered only after its metadata has been built
+class Continent : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int id READ id WRITE setId NOTIFY idChanged)
+
+public:
+    Q_INVOKABLE Continent(QObject* parent = nullptr)
+        : QObject{parent}
+    {
+    }
+
+    int id() const { return m_id; }
+    void setId(int id)
+    {
+        m_id = id;
+        emit idChanged();
+    }
+
+signals:
+    void idChanged();
+
+private:
+    int m_id{0};
+};
+
 class MetadataCacheTest : public QObject
 {
     Q_OBJECT
@@ -40,6 +114,10 @@ private slots:
     void testDefaultMetadata();
     void testOneToOneReference();
     void testManyToOneReference();
+    void testNewInstance();
+    void testSharedBetweenCaches();
+    void testEntityTraits();
+    void testRegistrationAfterMetadataWarns();
 };
 
 MetadataCacheTest::MetadataCacheTest()
@@ -54,7 +132,7 @@ MetadataCacheTest::~MetadataCacheTest()
 
 void MetadataCacheTest::initTestCase()
 {
-    qRegisterOrmEntity<Town, Person>();
+    qRegisterOrmEntity<Town, Person, Country>();
 }
 
 void MetadataCacheTest::testDefaultMetadata()
@@ -171,6 +249,78 @@ void MetadataCacheTest::testManyToOneReference()
     QCOMPARE(populationPropertyMapping->referencedEntity()->className(), "Person");
 }
 
+void MetadataCacheTest::testNewInstance()
+{
+    QOrmMetadataCache cache;
+
+    // Town has been registered with a factory, Province is created by QMetaObject::newInstance()
+    QScopedPointer<QObject> town{cache.get<Town>().newInstance()};
+    QVERIFY(qobject_cast<Town*>(town.data()) != nullptr);
+
+    QScopedPointer<QObject> province{cache.get<Province>().newInstance()};
+    QVERIFY(qobject_cast<Province*>(province.data()) != nullptr);
+}
+
+void MetadataCacheTest::testSharedBetweenCaches()
+{
+    QOrmMetadataCache::preload<Town, Person>();
+
+    QOrmMetadataCache cache;
+    QOrmMetadataCache otherCache;
+
+    // the metadata is built once and returned by all caches
+    QCOMPARE(&cache.get<Town>(), &otherCache.get<Town>());
+    QCOMPARE(&cache.get<Person>(), &otherCache.get<Person>());
+    QCOMPARE(cache.get<Town>().className(), "Town");
+}
+
+void MetadataCacheTest::testEntityTraits()
+{
+    QOrmMetadataCache cache;
+    const QOrmMetadata& metadata = cache.get<Country>();
+
+    QCOMPARE(metadata.tableName(), "countries");
+
+    const QOrmPropertyMapping* idMapping = metadata.classPropertyMapping("id");
+    QVERIFY(idMapping != nullptr);
+    QVERIFY(idMapping->column() != nullptr);
+    QVERIFY(idMapping->isObjectId());
+    QCOMPARE(idMapping->tableFieldName(), "id");
+
+    const QOrmPropertyMapping* nameMapping = metadata.classPropertyMapping("name");
+    QVERIFY(nameMapping != nullptr);
+    QVERIFY(nameMapping->column() != nullptr);
+    QCOMPARE(nameMapping->tableFieldName(), "country_name");
+    QCOMPARE(metadata.tableFieldMapping("country_name"), nameMapping);
+
+    // the properties are accessed through the declared accessors
+    Country country;
+    QVERIFY(idMapping->write(&country, 42));
+    QVERIFY(nameMapping->write(&country, QString{"Austria"}));
+    QCOMPARE(country.id(), 42);
+    QCOMPARE(country.name(), "Austria");
+    QCOMPARE(idMapping->read(&country), QVariant{42});
+    QCOMPARE(nameMapping->read(&country), QVariant{"Austria"});
+
+    QVERIFY(nameMapping->write(&country, QVariant{}));
+    QCOMPARE(country.name(), QString{});
+
+    // properties without a column in the traits are mapped by name
+    QVERIFY(cache.get<Province>().classPropertyMapping("name")->column() == nullptr);
+}
+
+void MetadataCacheTest::testRegistrationAfterMetadataWarns()
+{
+    QOrmMetadataCache cache;
+    QCOMPARE(cache.get<Continent>().className(), "Continent");
+
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QtOrm: qRegisterOrmEntity<Continent>() is called after the metadata of "
+                         "Continent has been built and has no effect on it. Register entities "
+                         "before they are used.");
+    qRegisterOrmEntity<Continent>();
+}
+
 QTEST_APPLESS_MAIN(MetadataCacheTest)
 
 #include "tst_metadatacachetest.moc"
@@ -15,3 +15,5 @@ HEADERS += \
     domain/person.h \
 
 RESOURCES += ormsession.qrc
+
+qtorm_sqlite3_api: DEFINES += QTORM_USE_SQLITE3_API
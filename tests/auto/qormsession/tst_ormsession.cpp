@@ -21,8 +21,11 @@
 
 #include <QtTest>
 
+#include <QOrmEntityInstanceCache>
 #include <QOrmError>
+#include <QOrmLiveQuery>
 #include <QOrmMetadataCache>
+#include <QOrmRelation>
 #include <QOrmSession>
 #include <QOrmSqliteConfiguration>
 #include <QOrmSqliteProvider>
@@ -37,6 +40,20 @@
 
 #include "private/qormglobal_p.h"
 
+struct TownRow
+{
+    Q_GADGET
+
+    Q_PROPERTY(int id MEMBER id)
+    Q_PROPERTY(QString name MEMBER name)
+    Q_PROPERTY(int province MEMBER province)
+
+public:
+    int id{0};
+    QString name;
+    int province{0};
+};
+
 class SqliteSessionTest : public QObject
 {
     Q_OBJECT
@@ -57,13 +74,32 @@ private slots:
     void testSelectWithSingleStringFilter();
     void testSelectWithOrder();
     void testSelectFromNestedSelect();
+    void testSelectWithTypedProperties();
+    void testSelectAsGadget();
+    void testSelectColumns();
+    void testQueryResultConversions();
+    void testStatistics();
+    void testSlowQueryLog();
 
     void testMergeFailsWithInconsistentReferences();
     void testMergeOfExistingEntitiesWithExplicitIdsUpdates();
+    void testMergeWritesReferencedInstancesFirst();
+    void testRepeatedMergesAreCoalesced();
+    void testMergeOfReferenceCycle();
 
     void testRemoveInstance();
+    void testRemovedInstancesDeletedOnCommit();
 
     void testTransactionRollback();
+    void testTransactionRollbackRestoresPersistedValues();
+    void testNestedTransactionSavepoints();
+    void testUpsertRollbackRestoresExistingRow();
+
+    void testLiveQuery();
+    void testMatchesFilterExpression();
+
+    void testExternalChangesRefreshCachedInstances();
+    void testSqlite3ApiReadsAndWrites();
 
     void testSchemaCreatedForReferencedEntities();
     void testSchemaUpdated();
@@ -329,6 +365,212 @@ void SqliteSessionTest::testSelectFromNestedSelect()
     QCOMPARE(result.toVector().size(), 2);
 }
 
+void SqliteSessionTest::testSelectWithTypedProperties()
+{
+    QOrmSession session;
+
+    auto upperAustria = new Province{QString::fromUtf8("Oberösterreich")};
+    auto lowerAustria = new Province{QString::fromUtf8("Niederösterreich")};
+
+    auto freistadt = new Town{QString::fromUtf8("Freistadt"), upperAustria};
+    auto hagenberg = new Town{QString::fromUtf8("Hagenberg im Mühlkreis"), upperAustria};
+    auto melk = new Town{QString::fromUtf8("Melk"), lowerAustria};
+
+    upperAustria->setTowns({freistadt, hagenberg});
+    lowerAustria->setTowns({melk});
+
+    QVERIFY(session.merge(upperAustria, lowerAustria, freistadt, hagenberg, melk));
+
+    // typed properties produce resolved predicates
+    QOrmFilterTerminalPredicate predicate = Q_ORM_PROPERTY(Town, province) == upperAustria;
+    QVERIFY(predicate.isResolved());
+    QCOMPARE(predicate.propertyMapping()->classPropertyName(), QString::fromUtf8("province"));
+
+    auto result = session.from<Town>()
+                      .filter(predicate)
+                      .order(Q_ORM_PROPERTY(Town, name), Qt::DescendingOrder)
+                      .select()
+                      .toVector();
+
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result[0], hagenberg);
+    QCOMPARE(result[1], freistadt);
+
+    auto provinces = session.from<Province>()
+                         .filter(Q_ORM_PROPERTY(Province, name) != QString::fromUtf8("Tirol") &&
+                                 Q_ORM_PROPERTY(Province, id) > 0)
+                         .order(Q_ORM_PROPERTY(Province, name))
+                         .select()
+                         .toVector();
+
+    QCOMPARE(provinces.size(), 2);
+    QCOMPARE(provinces[0], lowerAustria);
+    QCOMPARE(provinces[1], upperAustria);
+}
+
+void SqliteSessionTest::testSelectAsGadget()
+{
+    QOrmSession session;
+
+    auto upperAustria = new Province{QString::fromUtf8("Oberösterreich")};
+    auto freistadt = new Town{QString::fromUtf8("Freistadt"), upperAustria};
+    auto hagenberg = new Town{QString::fromUtf8("Hagenberg im Mühlkreis"), upperAustria};
+
+    upperAustria->setTowns({freistadt, hagenberg});
+
+    QVERIFY(session.merge(upperAustria, freistadt, hagenberg));
+
+    // unsaved changes of cached instances are not visible in rows
+    freistadt->setName(QString::fromUtf8("Linz"));
+
+    std::vector<TownRow> rows =
+        session.from<Town>().order(Q_ORM_CLASS_PROPERTY(name)).selectAs<TownRow>();
+
+    QCOMPARE(session.lastError().type(), QOrm::ErrorType::None);
+    QCOMPARE(rows.size(), 2u);
+    QCOMPARE(rows[0].id, freistadt->id());
+    QCOMPARE(rows[0].name, QString::fromUtf8("Freistadt"));
+    QCOMPARE(rows[0].province, upperAustria->id());
+    QCOMPARE(rows[1].id, hagenberg->id());
+    QCOMPARE(rows[1].name, QString::fromUtf8("Hagenberg im Mühlkreis"));
+    QCOMPARE(rows[1].province, upperAustria->id());
+}
+
+void SqliteSessionTest::testSelectColumns()
+{
+    QOrmSession session;
+
+    auto upperAustria = new Province{QString::fromUtf8("Oberösterreich")};
+    auto freistadt = new Town{QString::fromUtf8("Freistadt"), upperAustria};
+    auto hagenberg = new Town{QString::fromUtf8("Hagenberg im Mühlkreis"), upperAustria};
+
+    upperAustria->setTowns({freistadt, hagenberg});
+
+    QVERIFY(session.merge(upperAustria, freistadt, hagenberg));
+
+    QOrmSqliteProvider* provider =
+        static_cast<QOrmSqliteProvider*>(session.configuration().provider());
+    QSqlQuery query{provider->database()};
+    QVERIFY(query.exec("INSERT INTO Town(name, province_id) VALUES (NULL, NULL)"));
+
+    auto batch = session.from<Town>()
+                     .order(Q_ORM_PROPERTY(Town, id))
+                     .selectColumns(Q_ORM_PROPERTY(Town, id), Q_ORM_PROPERTY(Town, name));
+
+    QCOMPARE(session.lastError().type(), QOrm::ErrorType::None);
+    QVERIFY((std::is_same_v<decltype(batch), QOrmColumnBatch<int, QString>>));
+    QCOMPARE(batch.size(), 3);
+
+    QCOMPARE(batch.column<0>(), (std::vector<int>{freistadt->id(), hagenberg->id(), 3}));
+    QCOMPARE(batch.column<1>()[0], QString::fromUtf8("Freistadt"));
+    QCOMPARE(batch.column<1>()[1], QString::fromUtf8("Hagenberg im Mühlkreis"));
+    QCOMPARE(batch.column<1>()[2], QString{});
+
+    QCOMPARE(batch.nulls<0>().count(true), 0);
+    QVERIFY(!batch.isNull<1>(0));
+    QVERIFY(!batch.isNull<1>(1));
+    QVERIFY(batch.isNull<1>(2));
+}
+
+void SqliteSessionTest::testQueryResultConversions()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+
+    QVERIFY(session.merge(upperAustria, lowerAustria));
+
+    QOrmQuery query =
+        session.from<Province>().order(Q_ORM_CLASS_PROPERTY(id)).build(QOrm::Operation::Read);
+
+    {
+        QOrmQueryResult<Province> result{session.execute(query)};
+        QVector<Province*> provinces = std::move(result).takeVector();
+        QCOMPARE(provinces, (QVector<Province*>{upperAustria, lowerAustria}));
+    }
+
+    {
+        // instances of other entities are replaced with nullptr
+        QOrmQueryResult<Town> result{session.execute(query)};
+        QCOMPARE(result.toVector(), (QVector<Town*>{nullptr, nullptr}));
+    }
+
+    {
+        std::vector<Province*> provinces =
+            session.from<Province>().order(Q_ORM_CLASS_PROPERTY(id)).select().takeStdVector();
+        QCOMPARE(provinces, (std::vector<Province*>{upperAustria, lowerAustria}));
+    }
+}
+
+void SqliteSessionTest::testStatistics()
+{
+    QOrmSession session;
+
+    QStringList observedStatements;
+    session.setStatementObserver([&observedStatements](const QOrmStatementEvent& event) {
+        QVERIFY(event.isSuccessful());
+        observedStatements.push_back(event.statement());
+    });
+
+    QVERIFY(session.merge(new Province(QString::fromUtf8("Oberösterreich")),
+                          new Province(QString::fromUtf8("Niederösterreich"))));
+
+    QCOMPARE(session.statistics().rowsWritten(), qint64{2});
+    QVERIFY(session.statistics().schemaSynchronizationLatency().count() > 0);
+    QCOMPARE(session.statistics().executeLatency().count(), qint64{observedStatements.size()});
+
+    session.resetStatistics();
+    QCOMPARE(session.from<Province>().select().toVector().size(), 2);
+
+    QOrmStatistics statistics = session.statistics();
+    QCOMPARE(statistics.rowsWritten(), qint64{0});
+    QCOMPARE(statistics.rowsRead(), qint64{2});
+    QCOMPARE(statistics.hydrateLatency().count(), qint64{1});
+
+    // both read instances were found in the cache
+    QCOMPARE(statistics.cacheHits(), qint64{2});
+    QCOMPARE(statistics.cacheMisses(), qint64{0});
+    QCOMPARE(statistics.cacheHitRate(), 1.0);
+
+    QVERIFY(std::any_of(statistics.statements().cbegin(),
+                        statistics.statements().cend(),
+                        [](const QOrmStatementStatistics& statement) {
+                            return statement.rowsRead() == 2 && statement.executions() == 1;
+                        }));
+
+    session.resetStatistics();
+    QCOMPARE(session.statistics().statements().size(), 0);
+    QCOMPARE(session.statistics().rowsRead(), qint64{0});
+    QCOMPARE(session.statistics().cacheHits(), qint64{0});
+}
+
+void SqliteSessionTest::testSlowQueryLog()
+{
+    QOrmSqliteConfiguration sqliteConfiguration;
+    sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Recreate);
+    sqliteConfiguration.setDatabaseName("testdb.db");
+    // every statement is slow
+    sqliteConfiguration.setSlowQueryThreshold(0);
+    QOrmSqliteProvider* sqliteProvider = new QOrmSqliteProvider{sqliteConfiguration};
+    QOrmSessionConfiguration sessionConfiguration{sqliteProvider, true};
+    QOrmSession session{sessionConfiguration};
+
+    QVERIFY(session.merge(new Province(QString::fromUtf8("Oberösterreich"))));
+
+    QTest::ignoreMessage(QtWarningMsg,
+                         QRegularExpression{"^Slow query \\(\\d+ ms, 1 rows\\): SELECT .*"});
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression{"^Bound parameters:.*"});
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression{"^Query plan: (SCAN|SEARCH) .*"});
+
+    QOrmQueryResult<Province> result =
+        session.from<Province>()
+            .filter(Q_ORM_CLASS_PROPERTY(name) == QString::fromUtf8("Oberösterreich"))
+            .select();
+
+    QCOMPARE(result.toVector().size(), 1);
+}
+
 void SqliteSessionTest::testMergeFailsWithInconsistentReferences()
 {
     QOrmSession session;
@@ -376,17 +618,29 @@ void SqliteSessionTest::testMergeOfExistingEntitiesWithExplicitIdsUpdates()
     {
         QOrmSession session{QOrmSessionConfiguration::fromFile(":/qtorm_bypass_schema.json")};
 
-        Province* upperAustria = new Province(idUpperAustria, QString::fromUtf8("Oberösterreich"));
-        Province* lowerAustria =
-            new Province(idLowerAustria, QString::fromUtf8("Niederösterreich"));
+        Province* upperAustria = new Province(idUpperAustria, QString::fromUtf8("Upper Austria"));
+        Province* lowerAustria = new Province(idLowerAustria, QString::fromUtf8("Lower Austria"));
 
-        session.merge(upperAustria, lowerAustria);
+        // detached instances with known object IDs update the existing rows
+        QVERIFY(session.merge({upperAustria, lowerAustria}, QOrm::MergeMode::Upsert));
 
-        QEXPECT_FAIL("", "Not supported yet", TestFailMode::Abort);
         QCOMPARE(upperAustria->id(), idUpperAustria);
         QCOMPARE(lowerAustria->id(), idLowerAustria);
         QCOMPARE(session.from<Province>().select().toVector().size(), 2);
     }
+
+    {
+        QOrmSession session{QOrmSessionConfiguration::fromFile(":/qtorm_bypass_schema.json")};
+
+        auto provinces =
+            session.from<Province>().order(Q_ORM_CLASS_PROPERTY(id)).select().toVector();
+
+        QCOMPARE(provinces.size(), 2);
+        QCOMPARE(provinces[0]->id(), idUpperAustria);
+        QCOMPARE(provinces[0]->name(), QString::fromUtf8("Upper Austria"));
+        QCOMPARE(provinces[1]->id(), idLowerAustria);
+        QCOMPARE(provinces[1]->name(), QString::fromUtf8("Lower Austria"));
+    }
 }
 
 void SqliteSessionTest::testTransactionRollback()
@@ -409,6 +663,348 @@ void SqliteSessionTest::testTransactionRollback()
     QCOMPARE(upperAustria->name(), QString::fromUtf8("Oberösterreich"));
 }
 
+void SqliteSessionTest::testTransactionRollbackRestoresPersistedValues()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    QVERIFY(session.merge(upperAustria));
+
+    QVERIFY(session.beginTransaction());
+
+    // the instance is edited before it is written in the transaction
+    upperAustria->setName(QString::fromUtf8("Upper Austria"));
+    QVERIFY(session.merge(upperAustria));
+    QVERIFY(session.flush());
+
+    upperAustria->setName(QString::fromUtf8("Haut-Autriche"));
+
+    session.resetStatistics();
+    QVERIFY(session.rollbackTransaction());
+
+    // the values last read from or written to the database are restored without reading them
+    QCOMPARE(upperAustria->name(), QString::fromUtf8("Oberösterreich"));
+    QVERIFY(!session.entityInstanceCache()->isModified(upperAustria));
+    QCOMPARE(session.statistics().rowsRead(), qint64{0});
+
+    QCOMPARE(session.from<Province>().select().toVector(), QVector<Province*>{upperAustria});
+    QCOMPARE(upperAustria->name(), QString::fromUtf8("Oberösterreich"));
+}
+
+void SqliteSessionTest::testNestedTransactionSavepoints()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+    Province* styria = new Province(QString::fromUtf8("Steiermark"));
+
+    QVERIFY(session.beginTransaction());
+    QVERIFY(session.merge(upperAustria));
+
+    // rolled back to the savepoint: the outer transaction keeps its changes
+    lowerAustria->setId(0);
+    QVERIFY(session.beginTransaction());
+    QVERIFY(session.merge(lowerAustria));
+    QVERIFY(session.flush());
+    QVERIFY(lowerAustria->id() != 0);
+    QVERIFY(session.rollbackTransaction());
+
+    QVERIFY(session.isTransactionActive());
+    QCOMPARE(lowerAustria->id(), 0);
+    QVERIFY(!session.entityInstanceCache()->contains(lowerAustria));
+    QCOMPARE(session.from<Province>().select().toVector(), QVector<Province*>{upperAustria});
+
+    // released: the changes become part of the outer transaction
+    QVERIFY(session.beginTransaction());
+    QVERIFY(session.merge(styria));
+    QVERIFY(session.commitTransaction());
+
+    QVERIFY(session.isTransactionActive());
+    QVERIFY(session.commitTransaction());
+    QVERIFY(!session.isTransactionActive());
+
+    QCOMPARE(session.from<Province>().select().toVector(),
+             (QVector<Province*>{upperAustria, styria}));
+
+    delete lowerAustria;
+}
+
+void SqliteSessionTest::testUpsertRollbackRestoresExistingRow()
+{
+    int idUpperAustria = -1;
+
+    {
+        QOrmSession session;
+
+        Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+        QVERIFY(session.merge(upperAustria));
+
+        idUpperAustria = upperAustria->id();
+    }
+
+    QOrmSession session{QOrmSessionConfiguration::fromFile(":/qtorm_bypass_schema.json")};
+
+    QObject context;
+    std::vector<std::pair<QOrm::Operation, QObject*>> changes;
+    session.addEntityChangeListener<Province>(
+        &context, [&changes](QOrm::Operation operation, QObject* instance) {
+            changes.emplace_back(operation, instance);
+        });
+
+    Province* upperAustria = new Province(idUpperAustria, QString::fromUtf8("Upper Austria"));
+    Province* tirol = new Province(QString::fromUtf8("Tirol"));
+    tirol->setId(0);
+
+    QVERIFY(session.beginTransaction());
+    QVERIFY(session.merge(upperAustria, QOrm::MergeMode::Upsert));
+    QVERIFY(session.merge(tirol, QOrm::MergeMode::Upsert));
+    QVERIFY(session.flush());
+    QVERIFY(session.rollbackTransaction());
+
+    // the existing row has been updated and is read again, the new row is gone
+    QVERIFY(session.entityInstanceCache()->contains(upperAustria));
+    QVERIFY(!session.entityInstanceCache()->isModified(upperAustria));
+    QCOMPARE(upperAustria->id(), idUpperAustria);
+    QCOMPARE(upperAustria->name(), QString::fromUtf8("Oberösterreich"));
+
+    QVERIFY(!session.entityInstanceCache()->contains(tirol));
+    QCOMPARE(tirol->id(), 0);
+
+    QCOMPARE(changes.size(), size_t{4});
+    QCOMPARE(changes[0].first, QOrm::Operation::Merge);
+    QCOMPARE(changes[1].first, QOrm::Operation::Merge);
+    QCOMPARE(changes[2].first, QOrm::Operation::Delete);
+    QCOMPARE(changes[2].second, static_cast<QObject*>(tirol));
+    QCOMPARE(changes[3].first, QOrm::Operation::Update);
+    QCOMPARE(changes[3].second, static_cast<QObject*>(upperAustria));
+
+    QCOMPARE(session.from<Province>().select().toVector(), QVector<Province*>{upperAustria});
+
+    delete tirol;
+}
+
+void SqliteSessionTest::testLiveQuery()
+{
+    QOrmSession session;
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    Province* lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+    Province* tirol = new Province(QString::fromUtf8("Tirol"));
+
+    QVERIFY(session.merge(upperAustria, lowerAustria, tirol));
+
+    QOrmLiveQuery liveQuery{session,
+                            session.from<Province>()
+                                .filter(Q_ORM_CLASS_PROPERTY(name) != QString::fromUtf8("Tirol"))
+                                .order(Q_ORM_CLASS_PROPERTY(name))
+                                .build(QOrm::Operation::Read)};
+
+    QCOMPARE(liveQuery.error().type(), QOrm::ErrorType::None);
+    QCOMPARE(liveQuery.instances(), (QVector<QObject*>{lowerAustria, upperAustria}));
+
+    QSignalSpy insertSpy{&liveQuery, &QOrmLiveQuery::instanceInserted};
+    QSignalSpy updateSpy{&liveQuery, &QOrmLiveQuery::instanceUpdated};
+    QSignalSpy moveSpy{&liveQuery, &QOrmLiveQuery::instanceMoved};
+    QSignalSpy removeSpy{&liveQuery, &QOrmLiveQuery::instanceRemoved};
+    QSignalSpy refreshSpy{&liveQuery, &QOrmLiveQuery::refreshed};
+
+    // a new matching instance is inserted at its position in the order
+    Province* burgenland = new Province(QString::fromUtf8("Burgenland"));
+    QVERIFY(session.merge(burgenland));
+
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy[0][0].toInt(), 0);
+    QCOMPARE(liveQuery.instances(),
+             (QVector<QObject*>{burgenland, lowerAustria, upperAustria}));
+
+    // an update that changes the order moves the instance
+    burgenland->setName(QString::fromUtf8("Wien"));
+    QVERIFY(session.merge(burgenland));
+
+    QCOMPARE(updateSpy.count(), 1);
+    QCOMPARE(moveSpy.count(), 1);
+    QCOMPARE(moveSpy[0][0].toInt(), 0);
+    QCOMPARE(moveSpy[0][1].toInt(), 2);
+    QCOMPARE(liveQuery.instances(),
+             (QVector<QObject*>{lowerAustria, upperAustria, burgenland}));
+
+    // an instance that does not match the filter anymore is removed
+    burgenland->setName(QString::fromUtf8("Tirol"));
+    QVERIFY(session.merge(burgenland));
+
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(removeSpy[0][0].toInt(), 2);
+    QCOMPARE(liveQuery.instances(), (QVector<QObject*>{lowerAustria, upperAustria}));
+
+    // removed instances and rolled back creates are removed as well
+    QVERIFY(session.remove(upperAustria));
+
+    QCOMPARE(removeSpy.count(), 2);
+    QCOMPARE(liveQuery.instances(), QVector<QObject*>{lowerAustria});
+
+    Province* salzburg = new Province(QString::fromUtf8("Salzburg"));
+
+    {
+        auto transactionToken = session.declareTransaction(QOrm::TransactionPropagation::Require,
+                                                           QOrm::TransactionAction::Rollback);
+
+        QVERIFY(session.merge(salzburg));
+        QVERIFY(session.flush());
+        QCOMPARE(liveQuery.instances(), (QVector<QObject*>{lowerAustria, salzburg}));
+    }
+
+    QCOMPARE(removeSpy.count(), 3);
+    QCOMPARE(liveQuery.instances(), QVector<QObject*>{lowerAustria});
+
+    // the query has never been executed again
+    QCOMPARE(refreshSpy.count(), 0);
+
+    delete salzburg;
+}
+
+void SqliteSessionTest::testMatchesFilterExpression()
+{
+    QOrmMetadataCache metadataCache;
+    QOrmRelation relation{metadataCache.get<Town>()};
+
+    auto matches = [&relation](const Town* town, const QOrmFilterExpression& expression) {
+        return QOrmPrivate::matchesFilterExpression(
+            town, QOrmPrivate::resolvedFilterExpression(relation, expression));
+    };
+
+    Province upperAustria{1, QString::fromUtf8("Oberösterreich")};
+    Province lowerAustria{2, QString::fromUtf8("Niederösterreich")};
+
+    Town hagenberg{QString::fromUtf8("Hagenberg"), &upperAustria};
+    hagenberg.setId(1);
+    Town melk{QString::fromUtf8("Melk"), &lowerAustria};
+    melk.setId(2);
+    // the province is NULL in the database
+    Town nowhere{QString::fromUtf8("Nowhere"), nullptr};
+    nowhere.setId(3);
+
+    auto inUpperAustria = Q_ORM_CLASS_PROPERTY(province) == &upperAustria;
+    auto isNowhere = Q_ORM_CLASS_PROPERTY(name) == QString::fromUtf8("Nowhere");
+
+    // references are compared by object ID
+    QVERIFY(matches(&hagenberg, inUpperAustria));
+    QVERIFY(!matches(&melk, inUpperAustria));
+    QVERIFY(matches(&melk, Q_ORM_CLASS_PROPERTY(id) > 1));
+    QVERIFY(!matches(&hagenberg, Q_ORM_CLASS_PROPERTY(id) > 1));
+
+    // a comparison with NULL is unknown, and so is its negation
+    QVERIFY(!matches(&nowhere, inUpperAustria));
+    QVERIFY(!matches(&nowhere, !inUpperAustria));
+    QVERIFY(matches(&melk, !inUpperAustria));
+    QVERIFY(!matches(&hagenberg, Q_ORM_CLASS_PROPERTY(name) == QVariant{}));
+    QVERIFY(!matches(&hagenberg, !(Q_ORM_CLASS_PROPERTY(name) == QVariant{})));
+
+    // unknown OR true is true, unknown AND true is unknown
+    QVERIFY(matches(&nowhere, inUpperAustria || isNowhere));
+    QVERIFY(!matches(&nowhere, inUpperAustria && isNowhere));
+    QVERIFY(!matches(&nowhere, !(inUpperAustria && isNowhere)));
+
+    // unknown AND false is false, unknown OR false is unknown
+    QVERIFY(matches(&nowhere, !(inUpperAustria && !isNowhere)));
+    QVERIFY(!matches(&nowhere, inUpperAustria || !isNowhere));
+    QVERIFY(!matches(&nowhere, !(inUpperAustria || !isNowhere)));
+}
+
+void SqliteSessionTest::testExternalChangesRefreshCachedInstances()
+{
+    QOrmSqliteConfiguration sqliteConfiguration{};
+    sqliteConfiguration.setVerbose(true);
+    sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Recreate);
+    sqliteConfiguration.setDatabaseName("testdb.db");
+    sqliteConfiguration.setDetectExternalChanges(true);
+    QOrmSqliteProvider* sqliteProvider = new QOrmSqliteProvider{sqliteConfiguration};
+    QOrmSessionConfiguration sessionConfiguration{sqliteProvider, true};
+    QOrmSession session{sessionConfiguration};
+
+    Province* upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    QVERIFY(session.merge(upperAustria));
+    QCOMPARE(session.from<Province>().select().toVector(), QVector<Province*>{upperAustria});
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "external");
+        db.setDatabaseName("testdb.db");
+        QVERIFY(db.open());
+
+        QSqlQuery query = db.exec("UPDATE Province SET name = 'Upper Austria'");
+        QCOMPARE(query.lastError().type(), QSqlError::NoError);
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("external");
+
+    // the cached instance is returned with the values written by the other connection
+    QCOMPARE(session.from<Province>().select().toVector(), QVector<Province*>{upperAustria});
+    QCOMPARE(upperAustria->name(), QString::fromUtf8("Upper Austria"));
+    QVERIFY(!session.entityInstanceCache()->isModified(upperAustria));
+    QVERIFY(!session.entityInstanceCache()->isStale(upperAustria));
+}
+
+void SqliteSessionTest::testSqlite3ApiReadsAndWrites()
+{
+#ifndef QTORM_USE_SQLITE3_API
+    QSKIP("QtOrm is built without QTORM_USE_SQLITE3_API");
+#endif
+
+    QOrmSqliteConfiguration sqliteConfiguration{};
+    sqliteConfiguration.setVerbose(true);
+    sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Recreate);
+    sqliteConfiguration.setDatabaseName("testdb.db");
+    sqliteConfiguration.setUseSqlite3Api(true);
+
+    {
+        QOrmSessionConfiguration sessionConfiguration{
+            new QOrmSqliteProvider{sqliteConfiguration}, true};
+        QOrmSession session{sessionConfiguration};
+
+        Town* hagenberg = new Town{QString::fromUtf8("Hagenberg"), nullptr};
+        Person* franzHuber =
+            new Person{QString::fromUtf8("Franz"), QString::fromUtf8("Huber"), hagenberg};
+        Person* lisaMaier =
+            new Person{QString::fromUtf8("Lisa"), QString::fromUtf8("Maier"), nullptr};
+
+        QVERIFY(session.merge(hagenberg, franzHuber, lisaMaier));
+        QCOMPARE(franzHuber->id(), 1);
+        QCOMPARE(lisaMaier->id(), 2);
+
+        lisaMaier->setLastName(QString::fromUtf8("Müller"));
+        QVERIFY(session.merge(lisaMaier));
+    }
+
+    sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Bypass);
+    QOrmSessionConfiguration sessionConfiguration{new QOrmSqliteProvider{sqliteConfiguration},
+                                                  true};
+    QOrmSession session{sessionConfiguration};
+
+    auto result = session.from<Person>().order(Q_ORM_CLASS_PROPERTY(id)).select();
+    QCOMPARE(result.error().type(), QOrm::ErrorType::None);
+
+    auto data = result.toVector();
+    QCOMPARE(data.size(), 2);
+
+    QCOMPARE(data[0]->id(), 1);
+    QCOMPARE(data[0]->firstName(), QString::fromUtf8("Franz"));
+    QVERIFY(data[0]->town() != nullptr);
+    QCOMPARE(data[0]->town()->name(), QString::fromUtf8("Hagenberg"));
+
+    QCOMPARE(data[1]->id(), 2);
+    QCOMPARE(data[1]->lastName(), QString::fromUtf8("Müller"));
+    QVERIFY(data[1]->town() == nullptr);
+
+    auto filtered = session.from<Person>()
+                        .filter(Q_ORM_CLASS_PROPERTY(lastName) == QString::fromUtf8("Huber"))
+                        .select();
+    QCOMPARE(filtered.toVector(), QVector<Person*>{data[0]});
+
+    QVERIFY(session.remove(data[1]));
+    QCOMPARE(session.from<Person>().count(), 1);
+}
+
 void SqliteSessionTest::testSchemaCreatedForReferencedEntities()
 {
     {
@@ -480,6 +1076,126 @@ void SqliteSessionTest::testSchemaUpdated()
     }
 }
 
+void SqliteSessionTest::testMergeWritesReferencedInstancesFirst()
+{
+    QOrmSession session;
+
+    QStringList writes;
+    session.setStatementObserver([&writes](const QOrmStatementEvent& event) {
+        if (event.statement().startsWith("INSERT") || event.statement().startsWith("UPDATE"))
+            writes.push_back(event.statement());
+    });
+
+    auto upperAustria = new Province{QString::fromUtf8("Oberösterreich")};
+    auto hagenberg = new Town{QString::fromUtf8("Hagenberg im Mühlkreis"), upperAustria};
+    upperAustria->setTowns({hagenberg});
+
+    QVERIFY(session.beginTransaction());
+
+    // the town is merged first, but it cannot be written before its province
+    QVERIFY(session.merge(hagenberg));
+    QVERIFY(session.merge(upperAustria));
+    QVERIFY(writes.isEmpty());
+
+    QVERIFY(session.commitTransaction());
+
+    QCOMPARE(writes.size(), 2);
+    QVERIFY(writes[0].startsWith("INSERT INTO Province("));
+    QVERIFY(writes[1].startsWith("INSERT INTO Town("));
+
+    QOrmSqliteProvider* provider =
+        static_cast<QOrmSqliteProvider*>(session.configuration().provider());
+    QSqlQuery query{provider->database()};
+    QVERIFY(query.exec("SELECT province_id FROM Town"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), upperAustria->id());
+}
+
+void SqliteSessionTest::testRepeatedMergesAreCoalesced()
+{
+    QOrmSession session;
+
+    auto upperAustria = new Province{QString::fromUtf8("Oberösterreich")};
+    QVERIFY(session.merge(upperAustria));
+
+    QStringList writes;
+    session.setStatementObserver([&writes](const QOrmStatementEvent& event) {
+        if (event.statement().startsWith("INSERT") || event.statement().startsWith("UPDATE"))
+            writes.push_back(event.statement());
+    });
+    session.resetStatistics();
+
+    auto styria = new Province{QString::fromUtf8("Steiermark")};
+
+    QVERIFY(session.beginTransaction());
+
+    QVERIFY(session.merge(styria));
+    QVERIFY(session.merge(styria));
+
+    upperAustria->setName(QString::fromUtf8("Upper Austria"));
+    QVERIFY(session.merge(upperAustria));
+    upperAustria->setName(QString::fromUtf8("Oberösterreich ob der Enns"));
+    QVERIFY(session.merge(upperAustria));
+
+    QVERIFY(session.commitTransaction());
+
+    // one write per instance, with the values at the time of the flush
+    QCOMPARE(writes.size(), 2);
+    QVERIFY(writes[0].startsWith("INSERT INTO Province("));
+    QVERIFY(writes[1].startsWith("UPDATE Province "));
+    QCOMPARE(session.statistics().rowsWritten(), qint64{2});
+
+    QOrmSqliteProvider* provider =
+        static_cast<QOrmSqliteProvider*>(session.configuration().provider());
+    QSqlQuery query{provider->database()};
+    QVERIFY(query.exec(
+        QStringLiteral("SELECT name FROM Province WHERE id = %1").arg(upperAustria->id())));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toString(), QString::fromUtf8("Oberösterreich ob der Enns"));
+}
+
+void SqliteSessionTest::testMergeOfReferenceCycle()
+{
+    QOrmSession session;
+
+    QStringList writes;
+    session.setStatementObserver([&writes](const QOrmStatementEvent& event) {
+        if (event.statement().startsWith("INSERT") || event.statement().startsWith("UPDATE"))
+            writes.push_back(event.statement());
+    });
+
+    auto franzHuber = new Person{QString::fromUtf8("Franz"), QString::fromUtf8("Huber"), nullptr};
+    auto lisaMaier = new Person{QString::fromUtf8("Lisa"), QString::fromUtf8("Maier"), nullptr};
+
+    franzHuber->setPersonParent(lisaMaier);
+    franzHuber->setPersonChildren({lisaMaier});
+    lisaMaier->setPersonParent(franzHuber);
+    lisaMaier->setPersonChildren({franzHuber});
+
+    QVERIFY(session.merge(franzHuber));
+
+    // Lisa is inserted before Franz has an object ID and her reference is written again
+    QCOMPARE(writes.size(), 3);
+    QVERIFY(writes[0].startsWith("INSERT INTO Person("));
+    QVERIFY(writes[1].startsWith("INSERT INTO Person("));
+    QVERIFY(writes[2].startsWith("UPDATE Person "));
+
+    QOrmSqliteProvider* provider =
+        static_cast<QOrmSqliteProvider*>(session.configuration().provider());
+    QSqlQuery query{provider->database()};
+    QVERIFY(query.exec("SELECT id, personParent_id FROM Person ORDER BY id"));
+
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), lisaMaier->id());
+    QCOMPARE(query.value(1).toInt(), franzHuber->id());
+
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), franzHuber->id());
+    QCOMPARE(query.value(1).toInt(), lisaMaier->id());
+
+    QVERIFY(!query.next());
+}
+
 void SqliteSessionTest::testRemoveInstance()
 {
     QOrmSession session;
@@ -490,6 +1206,35 @@ void SqliteSessionTest::testRemoveInstance()
     QVERIFY(session.from<Province>().select().toVector().empty());
 }
 
+void SqliteSessionTest::testRemovedInstancesDeletedOnCommit()
+{
+    QOrmSession session;
+
+    QPointer<Province> upperAustria = new Province(QString::fromUtf8("Oberösterreich"));
+    QPointer<Province> lowerAustria = new Province(QString::fromUtf8("Niederösterreich"));
+
+    QVERIFY(session.merge(upperAustria.data(), lowerAustria.data()));
+
+    {
+        auto transactionToken = session.declareTransaction(QOrm::TransactionPropagation::Require,
+                                                           QOrm::TransactionAction::Commit);
+
+        QVERIFY(session.remove(upperAustria.data()));
+        QVERIFY(session.remove(lowerAustria.data()));
+
+        // merged again after its removal: the instance is persistent again
+        QVERIFY(session.merge(lowerAustria.data()));
+        QVERIFY(session.flush());
+
+        QVERIFY(transactionToken.commit());
+    }
+
+    // deleted without an event loop
+    QVERIFY(upperAustria.isNull());
+    QVERIFY(!lowerAustria.isNull());
+    QCOMPARE(session.from<Province>().count(), 1);
+}
+
 QTEST_GUILESS_MAIN(SqliteSessionTest)
 
 #include "tst_ormsession.moc"
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmarkrecorder.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QXmlStreamReader>
+
+BenchmarkRecorder::BenchmarkRecorder(QStringList& arguments)
+{
+    int index = arguments.indexOf("-json");
+
+    if (index < 0 || index + 1 >= arguments.size())
+        return;
+
+    m_jsonFileName = arguments.takeAt(index + 1);
+    arguments.removeAt(index);
+
+    if (!m_xmlFile.open())
+    {
+        qWarning() << "Unable to create a temporary file:" << m_xmlFile.errorString();
+        m_jsonFileName.clear();
+        return;
+    }
+
+    m_xmlFile.close();
+
+    // the console output is kept
+    arguments << "-o" << m_xmlFile.fileName() + ",xml" << "-o" << "-,txt";
+}
+
+bool BenchmarkRecorder::write()
+{
+    if (m_jsonFileName.isEmpty())
+        return true;
+
+    if (!m_xmlFile.open())
+    {
+        qWarning() << "Unable to read the benchmark results:" << m_xmlFile.errorString();
+        return false;
+    }
+
+    QJsonObject root;
+    root["label"] = qEnvironmentVariable("QTORM_BENCHMARK_LABEL");
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml{&m_xmlFile};
+
+    while (!xml.atEnd())
+    {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        QXmlStreamAttributes attributes = xml.attributes();
+
+        if (xml.name() == QLatin1String("TestCase"))
+        {
+            root["testCase"] = attributes.value("name").toString();
+        }
+        else if (xml.name() == QLatin1String("TestFunction"))
+        {
+            function = attributes.value("name").toString();
+        }
+        else if (xml.name() == QLatin1String("BenchmarkResult"))
+        {
+            // the value is per iteration
+            results.append(QJsonObject{{"function", function},
+                                       {"tag", attributes.value("tag").toString()},
+                                       {"metric", attributes.value("metric").toString()},
+                                       {"value", attributes.value("value").toDouble()},
+                                       {"iterations", attributes.value("iterations").toInt()}});
+        }
+    }
+
+    if (xml.hasError())
+    {
+        qWarning() << "Unable to parse the benchmark results:" << xml.errorString();
+        return false;
+    }
+
+    root["results"] = results;
+
+    QFile jsonFile{m_jsonFileName};
+
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Unable to write" << m_jsonFileName << ":" << jsonFile.errorString();
+        return false;
+    }
+
+    jsonFile.write(QJsonDocument{root}.toJson());
+
+    return true;
+}
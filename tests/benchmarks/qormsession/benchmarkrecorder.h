@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARKRECORDER_H
+#define BENCHMARKRECORDER_H
+
+#include <QStringList>
+#include <QTemporaryFile>
+
+// Writes the results of QBENCHMARK to a JSON file for comparing them between commits. The
+// arguments "-json <file>" are replaced with an XML logger to a temporary file, which is converted
+// after the test run. The optional environment variable QTORM_BENCHMARK_LABEL, e.g. a commit
+// hash, is stored along with the results.
+class BenchmarkRecorder
+{
+public:
+    explicit BenchmarkRecorder(QStringList& arguments);
+
+    bool write();
+
+private:
+    QString m_jsonFileName;
+    QTemporaryFile m_xmlFile;
+};
+
+#endif // BENCHMARKRECORDER_H
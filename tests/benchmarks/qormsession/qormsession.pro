@@ -0,0 +1,15 @@
+QT = core sql testlib orm
+
+CONFIG += benchmark warn_on silent c++17
+
+TARGET = tst_bench_ormsession
+
+SOURCES += tst_bench_ormsession.cpp \
+    benchmarkrecorder.cpp \
+    ../../auto/qormsession/domain/province.cpp \
+    ../../auto/qormsession/domain/town.cpp \
+
+HEADERS += \
+    benchmarkrecorder.h \
+    ../../auto/qormsession/domain/province.h \
+    ../../auto/qormsession/domain/town.h \
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2020 Dmitriy Purgin <dmitriy.purgin@sequality.at>
+ * Copyright (C) 2020 sequality software engineering e.U. <office@sequality.at>
+ *
+ * This file is part of QtOrm library.
+ *
+ * QtOrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtOrm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with QtOrm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include <QOrmEntityInstanceCache>
+#include <QOrmEntityListModel>
+#include <QOrmMetadataCache>
+#include <QOrmSession>
+#include <QOrmSessionConfiguration>
+#include <QOrmSqliteConfiguration>
+#include <QOrmSqliteProvider>
+#include <QOrmTransactionToken>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "../../auto/qormsession/domain/province.h"
+#include "../../auto/qormsession/domain/town.h"
+
+#include "benchmarkrecorder.h"
+
+#include <memory>
+
+// Every benchmark runs at 1k and 100k rows. Set QTORM_BENCHMARK_LARGE to also run at 1M rows.
+// A database with N towns has N / 10 provinces with 10 towns each.
+class SqliteSessionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkBulkInsert_data();
+    void benchmarkBulkInsert();
+
+    void benchmarkReadById_data();
+    void benchmarkReadById();
+
+    void benchmarkFilteredScan_data();
+    void benchmarkFilteredScan();
+
+    void benchmarkGraphLoad_data();
+    void benchmarkGraphLoad();
+
+    void benchmarkUpdateDirty_data();
+    void benchmarkUpdateDirty();
+
+    void benchmarkListModelReset_data();
+    void benchmarkListModelReset();
+
+    void benchmarkIdentityMapLookup_data();
+    void benchmarkIdentityMapLookup();
+
+private:
+    static void addRowCounts();
+    static bool createSchema(const QString& databaseName);
+    static std::unique_ptr<QOrmSession> openSession(const QString& databaseName);
+
+    // returns the name of a database with the given number of towns, creating it on first use
+    QString populatedDatabase(int rows);
+
+    QHash<int, QString> m_databases;
+};
+
+void SqliteSessionBenchmark::initTestCase()
+{
+    qRegisterOrmEntity<Town, Province>();
+}
+
+void SqliteSessionBenchmark::cleanupTestCase()
+{
+    for (const QString& databaseName : qAsConst(m_databases))
+        QFile::remove(databaseName);
+
+    QFile::remove("bench_insert.db");
+}
+
+void SqliteSessionBenchmark::addRowCounts()
+{
+    QTest::addColumn<int>("rows");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+
+    if (qEnvironmentVariableIsSet("QTORM_BENCHMARK_LARGE"))
+        QTest::newRow("1M") << 1000000;
+}
+
+bool SqliteSessionBenchmark::createSchema(const QString& databaseName)
+{
+    QFile::remove(databaseName);
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "benchmark");
+    database.setDatabaseName(databaseName);
+
+    bool isSuccessful = database.open();
+    QSqlQuery query{database};
+
+    // the same schema as created by the provider, with an index on the back-reference
+    isSuccessful = isSuccessful &&
+                   query.exec("CREATE TABLE Province(id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                              "name TEXT)") &&
+                   query.exec("CREATE TABLE Town(id INTEGER PRIMARY KEY AUTOINCREMENT,name TEXT,"
+                              "province_id INTEGER)") &&
+                   query.exec("CREATE INDEX Town_province_id ON Town(province_id)");
+
+    if (!isSuccessful)
+        qWarning() << "Unable to create the schema:" << query.lastError().text();
+
+    query = QSqlQuery{};
+    database = QSqlDatabase{};
+    QSqlDatabase::removeDatabase("benchmark");
+
+    return isSuccessful;
+}
+
+std::unique_ptr<QOrmSession> SqliteSessionBenchmark::openSession(const QString& databaseName)
+{
+    QOrmSqliteConfiguration sqliteConfiguration;
+    sqliteConfiguration.setSchemaMode(QOrmSqliteConfiguration::SchemaMode::Bypass);
+    sqliteConfiguration.setDatabaseName(databaseName);
+    QOrmSqliteProvider* sqliteProvider = new QOrmSqliteProvider{sqliteConfiguration};
+
+    return std::make_unique<QOrmSession>(QOrmSessionConfiguration{sqliteProvider, false});
+}
+
+QString SqliteSessionBenchmark::populatedDatabase(int rows)
+{
+    if (m_databases.contains(rows))
+        return m_databases.value(rows);
+
+    QString databaseName = QString{"bench_%1.db"}.arg(rows);
+
+    if (!createSchema(databaseName))
+        return {};
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "benchmark");
+    database.setDatabaseName(databaseName);
+
+    // rows are inserted directly, the session is not measured here
+    bool isSuccessful = database.open() && database.transaction();
+    QSqlQuery query{database};
+    int provinces = qMax(1, rows / 10);
+
+    isSuccessful = isSuccessful && query.prepare("INSERT INTO Province(name) VALUES(?)");
+
+    for (int i = 1; isSuccessful && i <= provinces; ++i)
+    {
+        query.addBindValue(QString{"Province %1"}.arg(i));
+        isSuccessful = query.exec();
+    }
+
+    isSuccessful = isSuccessful && query.prepare("INSERT INTO Town(name, province_id) VALUES(?, ?)");
+
+    for (int i = 1; isSuccessful && i <= rows; ++i)
+    {
+        query.addBindValue(QString{"Town %1"}.arg(i));
+        query.addBindValue(1 + (i - 1) % provinces);
+        isSuccessful = query.exec();
+    }
+
+    isSuccessful = isSuccessful && database.commit();
+
+    if (!isSuccessful)
+        qWarning() << "Unable to populate the database:" << query.lastError().text();
+
+    query = QSqlQuery{};
+    database = QSqlDatabase{};
+    QSqlDatabase::removeDatabase("benchmark");
+
+    if (!isSuccessful)
+        return {};
+
+    m_databases.insert(rows, databaseName);
+
+    return databaseName;
+}
+
+void SqliteSessionBenchmark::benchmarkBulkInsert_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkBulkInsert()
+{
+    QFETCH(int, rows);
+
+    QVERIFY(createSchema("bench_insert.db"));
+    std::unique_ptr<QOrmSession> session = openSession("bench_insert.db");
+
+    QBENCHMARK_ONCE
+    {
+        QOrmTransactionToken token =
+            session->declareTransaction(QOrm::TransactionPropagation::Require,
+                                        QOrm::TransactionAction::Commit);
+
+        for (int i = 1; i <= rows; ++i)
+            QVERIFY(session->merge(new Province{QString{"Province %1"}.arg(i)}));
+
+        QVERIFY(token.commit());
+    }
+
+    QCOMPARE(session->from<Province>().count(), rows);
+}
+
+void SqliteSessionBenchmark::benchmarkReadById_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkReadById()
+{
+    QFETCH(int, rows);
+
+    QString databaseName = populatedDatabase(rows);
+    QVERIFY(!databaseName.isEmpty());
+
+    std::unique_ptr<QOrmSession> session = openSession(databaseName);
+
+    // a province is read with its towns
+    QVector<int> ids(1000);
+    QRandomGenerator random{42};
+
+    for (int& id : ids)
+        id = random.bounded(1, rows / 10 + 1);
+
+    QBENCHMARK
+    {
+        for (int id : qAsConst(ids))
+        {
+            QOrmQueryResult<Province> result =
+                session->from<Province>().filter(Q_ORM_CLASS_PROPERTY(id) == id).select();
+
+            QCOMPARE(result.toVector().size(), 1);
+        }
+    }
+}
+
+void SqliteSessionBenchmark::benchmarkFilteredScan_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkFilteredScan()
+{
+    QFETCH(int, rows);
+
+    QString databaseName = populatedDatabase(rows);
+    QVERIFY(!databaseName.isEmpty());
+
+    std::unique_ptr<QOrmSession> session = openSession(databaseName);
+
+    // the name is not indexed, the whole table is scanned for a single town
+    QString name = QString{"Town %1"}.arg(rows / 2);
+
+    QBENCHMARK
+    {
+        QOrmQueryResult<Town> result =
+            session->from<Town>().filter(Q_ORM_CLASS_PROPERTY(name) == name).select();
+
+        QCOMPARE(result.toVector().size(), 1);
+    }
+}
+
+void SqliteSessionBenchmark::benchmarkGraphLoad_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkGraphLoad()
+{
+    QFETCH(int, rows);
+
+    QString databaseName = populatedDatabase(rows);
+    QVERIFY(!databaseName.isEmpty());
+
+    // a new session on every iteration creates every instance and back-reference
+    QBENCHMARK
+    {
+        std::unique_ptr<QOrmSession> session = openSession(databaseName);
+        QVector<Province*> provinces = session->from<Province>().select().toVector();
+
+        QCOMPARE(provinces.size(), rows / 10);
+        QCOMPARE(provinces.front()->towns().size(), 10);
+    }
+}
+
+void SqliteSessionBenchmark::benchmarkUpdateDirty_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkUpdateDirty()
+{
+    QFETCH(int, rows);
+
+    QString databaseName = populatedDatabase(rows);
+    QVERIFY(!databaseName.isEmpty());
+
+    std::unique_ptr<QOrmSession> session = openSession(databaseName);
+    QVector<Town*> towns = session->from<Town>().select().toVector();
+    QCOMPARE(towns.size(), rows);
+
+    int revision = 0;
+    session->resetStatistics();
+
+    QBENCHMARK
+    {
+        ++revision;
+
+        QOrmTransactionToken token =
+            session->declareTransaction(QOrm::TransactionPropagation::Require,
+                                        QOrm::TransactionAction::Commit);
+
+        for (Town* town : qAsConst(towns))
+        {
+            town->setName(QString{"Town %1 (%2)"}.arg(town->id()).arg(revision));
+            QVERIFY(session->merge(town));
+        }
+
+        QVERIFY(token.commit());
+    }
+
+    // every iteration updates all towns
+    QCOMPARE(session->statistics().rowsWritten(), qint64{rows} * revision);
+}
+
+void SqliteSessionBenchmark::benchmarkListModelReset_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkListModelReset()
+{
+    QFETCH(int, rows);
+
+    QString databaseName = populatedDatabase(rows);
+    QVERIFY(!databaseName.isEmpty());
+
+    std::unique_ptr<QOrmSession> session = openSession(databaseName);
+    QOrmEntityListModel<Town> model{*session};
+    QCOMPARE(model.rowCount(), rows);
+
+    QBENCHMARK
+    {
+        model.read();
+    }
+
+    QCOMPARE(model.rowCount(), rows);
+}
+
+void SqliteSessionBenchmark::benchmarkIdentityMapLookup_data()
+{
+    addRowCounts();
+}
+
+void SqliteSessionBenchmark::benchmarkIdentityMapLookup()
+{
+    QFETCH(int, rows);
+
+    QOrmMetadataCache metadataCache;
+    const QOrmMetadata& metadata = metadataCache.get<Province>();
+
+    // the cache takes the ownership of the instances
+    QOrmEntityInstanceCache instanceCache;
+
+    for (int i = 1; i <= rows; ++i)
+        instanceCache.insert(metadata, new Province{i, QString{"Province %1"}.arg(i)});
+
+    QVector<QVariant> ids(rows);
+    QRandomGenerator random{42};
+
+    for (QVariant& id : ids)
+        id = random.bounded(1, rows + 1);
+
+    int found = 0;
+
+    QBENCHMARK
+    {
+        found = 0;
+
+        for (const QVariant& id : qAsConst(ids))
+        {
+            if (instanceCache.get(metadata, id) != nullptr)
+                ++found;
+        }
+    }
+
+    QCOMPARE(found, rows);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application{argc, argv};
+    QStringList arguments = application.arguments();
+
+    BenchmarkRecorder recorder{arguments};
+    SqliteSessionBenchmark benchmark;
+
+    int result = QTest::qExec(&benchmark, arguments);
+
+    return recorder.write() ? result : 1;
+}
+
+#include "tst_bench_ormsession.moc"